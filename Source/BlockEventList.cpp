@@ -0,0 +1,73 @@
+// BlockEventList.cpp
+
+#include "BlockEventList.h"
+#include <algorithm>
+
+namespace cc
+{
+    bool BlockEventList::add(int samplePosition, const juce::uint8* data, int numBytes)
+    {
+        if (numEvents >= maxEvents || numBytes <= 0 || bytesUsed + numBytes > maxBytes)
+        {
+            ++dropped;
+            return false;
+        }
+
+        std::memcpy(bytes.data() + bytesUsed, data, (size_t) numBytes);
+        if (numEvents > 0 && events[(size_t) numEvents - 1].samplePosition > samplePosition)
+            sorted = false;
+
+        events[(size_t) numEvents++] = Event { samplePosition, bytesUsed, numBytes };
+        bytesUsed += numBytes;
+        return true;
+    }
+
+    void BlockEventList::sort()
+    {
+        if (sorted)
+            return;
+
+        const auto byPosition = [](const Event& a, const Event& b) { return a.samplePosition < b.samplePosition; };
+        auto runEnd = [this](const Event* p, int start)
+        {
+            int end = start + 1;
+            while (end < numEvents && p[end - 1].samplePosition <= p[end].samplePosition)
+                ++end;
+            return end;
+        };
+
+        // Cada pasada fusiona tramos adyacentes de dos en dos (std::merge es estable) hasta que queda uno
+        Event* src = events.data();
+        Event* dst = mergeScratch.data();
+        for (;;)
+        {
+            int numRuns = 0;
+            for (int start = 0; start < numEvents; ++numRuns)
+            {
+                const int mid = runEnd(src, start);
+                const int end = mid < numEvents ? runEnd(src, mid) : mid;
+                std::merge(src + start, src + mid, src + mid, src + end, dst + start, byPosition);
+                start = end;
+            }
+            std::swap(src, dst);
+            if (numRuns <= 1)
+                break;
+        }
+
+        if (src != events.data())
+            std::copy(src, src + numEvents, events.data());
+        sorted = true;
+    }
+
+    void appendInOrder(juce::MidiBuffer& dest, int samplePosition, const juce::uint8* data, int numBytes)
+    {
+        juce::uint8 header[sizeof(juce::int32) + sizeof(juce::uint16)];
+        const auto pos  = (juce::int32) samplePosition;
+        const auto size = (juce::uint16) numBytes;
+        std::memcpy(header, &pos, sizeof(pos));
+        std::memcpy(header + sizeof(pos), &size, sizeof(size));
+
+        dest.data.addArray(header, (int) sizeof(header));
+        dest.data.addArray(data, numBytes);
+    }
+}
@@ -0,0 +1,65 @@
+// BlockEventList.h
+// Eventos generados para el bloque actual (array fijo ordenado) y mezcla lineal con el MIDI entrante
+
+#pragma once
+
+#include <juce_audio_basics/juce_audio_basics.h>
+#include <array>
+#include <utility>
+
+namespace cc
+{
+    // Lista de eventos con posición dentro del bloque. Capacidad y memoria fijas: se llena desde
+    // las distintas fuentes (cola, vivo, look-ahead) y se ordena una vez antes de mezclar.
+    class BlockEventList
+    {
+    public:
+        static constexpr int maxEvents = 4096;
+        static constexpr int maxBytes  = 65536;
+
+        struct Event
+        {
+            int samplePosition = 0;
+            int offset = 0;  // posición en el pool de bytes
+            int size = 0;
+        };
+
+        void clear() { numEvents = 0; bytesUsed = 0; sorted = true; }
+        int size() const { return numEvents; }
+        bool isEmpty() const { return numEvents == 0; }
+        bool isFull() const  { return numEvents >= maxEvents || bytesUsed + 3 > maxBytes; }
+
+        // Eventos descartados por falta de espacio desde la última llamada
+        int takeDropped() noexcept { return std::exchange(dropped, 0); }
+
+        // Devuelve false (y descarta el evento) si la lista está llena
+        bool add(int samplePosition, const juce::uint8* data, int numBytes);
+        bool add(int samplePosition, const juce::MidiMessage& msg) { return add(samplePosition, msg.getRawData(), msg.getRawDataSize()); }
+
+        // Orden estable por posición. Cada fuente entrega un tramo ordenado: se fusionan los tramos
+        // por parejas (merge natural, O(n log tramos)) sin asignar memoria.
+        void sort();
+
+        // Bytes MIDI almacenados (sin cabeceras de MidiBuffer)
+        int getNumBytes() const { return bytesUsed; }
+
+        const Event& operator[](int i) const { return events[(size_t) i]; }
+        const juce::uint8* getData(const Event& e) const { return bytes.data() + e.offset; }
+
+    private:
+        std::array<Event, maxEvents> events {};
+        std::array<Event, maxEvents> mergeScratch {};
+        std::array<juce::uint8, maxBytes> bytes {};
+        int numEvents = 0, bytesUsed = 0;
+        int dropped = 0;
+        bool sorted = true;
+    };
+
+    // Añade un evento al final de 'dest' sin búsqueda de posición: el llamador garantiza orden creciente.
+    // Escribe directamente en MidiBuffer::data con el mismo formato que MidiBuffer::addEvent
+    // (int32 posición, uint16 tamaño, bytes); addEvent recorre el buffer desde el principio en cada inserción.
+    void appendInOrder(juce::MidiBuffer& dest, int samplePosition, const juce::uint8* data, int numBytes);
+
+    // Tamaño en bytes que ocupa un evento dentro de MidiBuffer::data
+    constexpr int midiBufferBytesForEvent(int numBytes) { return (int) (sizeof(juce::int32) + sizeof(juce::uint16)) + numBytes; }
+}
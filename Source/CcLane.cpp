@@ -0,0 +1,54 @@
+// CcLane.cpp
+
+#include "CcLane.h"
+
+namespace cc
+{
+    namespace
+    {
+        using ShapeTable = std::array<juce::uint8, ccShapeTableSize + 1>;
+
+        template <typename Curve>
+        ShapeTable makeTable(Curve&& curve)
+        {
+            ShapeTable t {};
+            for (int i = 0; i <= ccShapeTableSize; ++i)
+            {
+                const double x = (double) i / ccShapeTableSize;
+                t[(size_t) i] = (juce::uint8) juce::jlimit(0, 127, (int) std::lround(127.0 * curve(x)));
+            }
+            return t;
+        }
+    }
+
+    const std::array<juce::uint8, ccShapeTableSize + 1>& getCcShapeTable(CcShape shape)
+    {
+        static const ShapeTable tables[] =
+        {
+            makeTable([](double)   { return 0.0; }),
+            makeTable([](double x) { return x; }),
+            makeTable([](double x) { return 1.0 - x; }),
+            makeTable([](double x) { return std::sin(x * juce::MathConstants<double>::pi); }),
+            makeTable([](double x) { return (std::exp(4.0 * x) - 1.0) / (std::exp(4.0) - 1.0); }),
+            makeTable([](double x) { return 0.5 + 0.5 * std::sin(x * 4.0 * juce::MathConstants<double>::pi); }),
+        };
+
+        const auto index = (size_t) juce::jlimit(0, (int) std::size(tables) - 1, (int) shape);
+        return tables[index];
+    }
+
+    void CcLane::start(juce::int64 time, juce::int64 length, CcShape newShape, int newChannel, int newController) noexcept
+    {
+        // Cambio de controlador: el último valor enviado no vale como referencia
+        if (newChannel != channel || newController != controller)
+            lastValue = -1;
+
+        active = newShape != CcShape::Off;
+        shape = newShape;
+        channel = newChannel;
+        controller = newController;
+        segmentStart = time;
+        segmentLength = juce::jmax((juce::int64) 1, length);
+        nextEval = time;
+    }
+}
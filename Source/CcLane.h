@@ -0,0 +1,89 @@
+// CcLane.h
+// Curvas de controlador sincronizadas con los acordes: tablas precalculadas y emisión con aclarado
+
+#pragma once
+
+#include <juce_core/juce_core.h>
+#include <array>
+#include "Parameters.h"
+
+namespace cc
+{
+    static constexpr int ccShapeTableSize = 256;
+
+    // Tabla de la curva (valores 0..127, índice = fase del acorde). Estática: la primera llamada construye
+    // todas las curvas, y prepareToPlay la hace antes de que el hilo de audio las lea.
+    const std::array<juce::uint8, ccShapeTableSize + 1>& getCcShapeTable(CcShape shape);
+
+    // Aclarado: un CC solo se envía si el valor cambia al menos 'threshold', o si cambió algo
+    // y han pasado 'minIntervalSamples' desde el último envío
+    struct CcThinning
+    {
+        int threshold = 2;
+        int minIntervalSamples = 0;
+    };
+
+    // Un segmento por acorde: start() lo reinicia en el instante del acorde y render() evalúa la curva en una
+    // rejilla de control fija. El coste por bloque está acotado (bloque / controlInterval evaluaciones).
+    class CcLane
+    {
+    public:
+        static constexpr int controlInterval = 32;  // samples entre evaluaciones de la curva
+        static constexpr int minIntervalMs = 20;    // reenvío de cambios pequeños como mucho cada 20 ms
+
+        void reset() noexcept
+        {
+            active = false;
+            lastValue = -1;
+            lastSent = std::numeric_limits<juce::int64>::min() / 2;
+        }
+
+        void start(juce::int64 time, juce::int64 length, CcShape newShape, int newChannel, int newController) noexcept;
+
+        // Evalúa [blockStart, blockStart + numSamples). sink(time, channel, controller, value); devuelve los CC enviados
+        template <typename Sink>
+        int render(juce::int64 blockStart, int numSamples, const CcThinning& thin, int maxEvents, Sink&& sink) noexcept
+        {
+            if (! active || shape == CcShape::Off)
+                return 0;
+
+            const juce::int64 blockEnd = blockStart + numSamples;
+            const auto& table = getCcShapeTable(shape);
+            int sent = 0;
+
+            while (nextEval < blockEnd && sent < maxEvents)
+            {
+                const juce::int64 t = juce::jmax(nextEval, blockStart);
+                const juce::int64 pos = juce::jmin(t - segmentStart, segmentLength);
+                const int value = table[(size_t) ((pos * ccShapeTableSize) / segmentLength)];
+                const bool isEnd = pos >= segmentLength;
+
+                const int delta = std::abs(value - lastValue);
+                if (lastValue < 0 || delta >= thin.threshold
+                    || (delta > 0 && (isEnd || t - lastSent >= thin.minIntervalSamples)))
+                {
+                    sink(t, channel, controller, value);
+                    lastValue = value;
+                    lastSent = t;
+                    ++sent;
+                }
+
+                if (isEnd)
+                {
+                    active = false;  // la curva se queda en su valor final hasta el siguiente acorde
+                    break;
+                }
+                nextEval = juce::jmin(t + controlInterval, segmentStart + segmentLength);
+            }
+            return sent;
+        }
+
+    private:
+        bool active = false;
+        CcShape shape = CcShape::Off;
+        int channel = 1, controller = 11;
+        juce::int64 segmentStart = 0, segmentLength = 1, nextEval = 0;
+        int lastValue = -1;
+        juce::int64 lastSent = 0;
+    };
+}
@@ -0,0 +1,62 @@
+// ChannelStates.h
+// Estado de la progresión en vivo por canal de entrada. Sin modo multitímbrico la entrada es un solo flujo
+// y solo se usa el canal 0; con él cada canal lleva su grado, su progresión, su humanización y sus notas
+// ligadas, y toca en su propio canal de salida.
+
+#pragma once
+
+#include <juce_core/juce_core.h>
+#include <array>
+#include "FastRandom.h"
+#include "LegatoVoices.h"
+
+namespace cc
+{
+    // Un array por campo: el avance por bloque recorre solo los campos pequeños de los 16 canales
+    struct ChannelStates
+    {
+        static constexpr int numChannels = 16;
+
+        std::array<juce::uint8, numChannels> degreeIndex {};
+        std::array<int, numChannels> samplesUntilAdvance {};        // avance de grado sin reloj
+        std::array<bool, numChannels> active {};                    // ha recibido note-ons: su progresión corre
+        std::array<juce::int8, numChannels> preset {};              // Program Change; -1 = preset global
+        std::array<juce::uint8, numChannels> lastHarmonyDegree {};  // armonizador: grado del último acorde (0 = ninguno)
+        std::array<juce::uint8, numChannels> lastKeyDegree {};      // teclado dividido: grado del último acorde
+        std::array<FastRandom, numChannels> rng;                    // humanización: un flujo por canal
+        std::array<LegatoVoices, numChannels> legato;
+
+        ChannelStates() { reset(); }
+
+        // Las notas ligadas deben soltarse antes (legato[i].releaseAll): aquí solo se olvidan
+        void reset() noexcept
+        {
+            restart();
+            active.fill(false);
+            preset.fill(-1);
+            lastHarmonyDegree.fill(0);
+            lastKeyDegree.fill(0);
+            for (auto& voices : legato)
+                voices.reset();
+        }
+
+        // Todas las progresiones vuelven al primer grado (arranque con semilla fija)
+        void restart() noexcept
+        {
+            degreeIndex.fill(0);
+            samplesUntilAdvance.fill(0);
+        }
+
+        // Semilla > 0: flujos reproducibles y distintos por canal; 0: no reproducible
+        void seed(int seed)
+        {
+            for (int ch = 0; ch < numChannels; ++ch)
+            {
+                if (seed > 0)
+                    rng[(size_t) ch].setSeed(ch == 0 ? (juce::uint64) seed : ((juce::uint64) seed << 40) | (juce::uint64) ch);
+                else
+                    rng[(size_t) ch].seedFromClock();
+            }
+        }
+    };
+}
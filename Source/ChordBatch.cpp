@@ -0,0 +1,203 @@
+// ChordBatch.cpp
+
+#include "ChordBatch.h"
+
+namespace cc
+{
+    namespace
+    {
+        constexpr int numVoices = ChordNotes::maxNotes;
+        constexpr int numScales = (int) ScaleType::Mixolydian + 1;
+        constexpr int tileSize = 64;  // acordes por pasada: las columnas del tile caben en L1
+        // Voz no presente: valor enorme que la ordenación deja al final. Los desplazamientos de rango
+        // se aplican a todas las voces sin máscara; 'absentLimit' la sigue distinguiendo.
+        constexpr int absent = std::numeric_limits<int>::max() / 2;
+        constexpr int absentLimit = absent / 2;
+
+        // Semitonos desde la raíz de cada voz (grados 1,3,5,7,9,11,13) por escala
+        struct VoiceOffsets
+        {
+            VoiceOffsets()
+            {
+                for (int s = 0; s < numScales; ++s)
+                {
+                    const auto& intervals = getScaleIntervalTable((ScaleType) s);
+                    for (int v = 0; v < numVoices; ++v)
+                    {
+                        const int degree = 1 + 2 * v;
+                        table[(size_t) s][(size_t) v] = intervals[(size_t) ((degree - 1) % 7)] + ((degree - 1) / 7) * 12;
+                    }
+                }
+            }
+
+            std::array<std::array<int, numVoices>, numScales> table {};
+        };
+
+        const VoiceOffsets& getVoiceOffsets()
+        {
+            static const VoiceOffsets instance;
+            return instance;
+        }
+
+        // Red de ordenación óptima para 7 elementos (16 comparadores). Cada comparador es un
+        // min/max sobre columnas completas del tile, sin ramas.
+        constexpr std::array<std::pair<int, int>, 16> sortNetwork7 { {
+            { 0, 6 }, { 2, 3 }, { 4, 5 }, { 0, 2 }, { 1, 4 }, { 3, 6 }, { 0, 1 }, { 2, 5 },
+            { 3, 4 }, { 1, 2 }, { 4, 6 }, { 2, 3 }, { 4, 5 }, { 1, 2 }, { 3, 4 }, { 5, 6 }
+        } };
+
+        // Inversiones que el tile resuelve: hasta 3 solo suben voces 1-3-5, siempre presentes y a
+        // menos de una octava de la raíz. Inversiones mayores pasan por makeChordNotes.
+        constexpr int maxTileInversion = 3;
+    }
+
+    void ChordBatch::resize(int numChords)
+    {
+        const auto n = (size_t) juce::jmax(0, numChords);
+        roots.resize(n);
+        scales.resize(n);
+        qualities.resize(n);
+        inversions.resize(n);
+        extensions.resize(n);
+        for (auto& column : notes)
+            column.resize(n);
+        sizes.resize(n);
+    }
+
+    void ChordBatch::set(int index, int root, ScaleType scale, ChordQuality quality, int inversion, const ExtensionToggles& toggles)
+    {
+        const auto i = (size_t) index;
+        roots[i]      = root;
+        scales[i]     = (juce::uint8) scale;
+        qualities[i]  = (juce::uint8) quality;
+        inversions[i] = (juce::uint8) juce::jlimit(0, 255, inversion);
+        extensions[i] = (juce::uint8) ((toggles.add7 ? add7Bit : 0) | (toggles.add9 ? add9Bit : 0)
+                                     | (toggles.add11 ? add11Bit : 0) | (toggles.add13 ? add13Bit : 0));
+    }
+
+    void ChordBatch::get(int index, ChordNotes& out) const
+    {
+        const auto i = (size_t) index;
+        out.size = sizes[i];
+        for (int v = 0; v < out.size; ++v)
+            out.notes[(size_t) v] = notes[(size_t) v][i];
+    }
+
+    void makeChordNotesBatch(ChordBatch& batch)
+    {
+        const int numChords = batch.size();
+        const auto& offsets = getVoiceOffsets().table;
+
+        std::array<std::array<int, tileSize>, numVoices> v;  // notas por voz (absent = no presente)
+        std::array<int, tileSize> count, lo, hi, shift;
+
+        for (int base = 0; base < numChords; base += tileSize)
+        {
+            const int n = juce::jmin(tileSize, numChords - base);
+            const int* roots             = batch.roots.data() + base;
+            const juce::uint8* scales    = batch.scales.data() + base;
+            const juce::uint8* qualities = batch.qualities.data() + base;
+            const juce::uint8* invs      = batch.inversions.data() + base;
+            const juce::uint8* exts      = batch.extensions.data() + base;
+
+            // Grado -> semitono y presencia de cada voz (1-3-5 siempre; 7..13 por calidad o extensión)
+            for (int voice = 0; voice < numVoices; ++voice)
+            {
+                const int minQuality = voice - 2;            // Seventh = 1 ... Thirteenth = 4
+                const int extBit = voice >= 3 ? 1 << (voice - 3) : 0;
+                for (int j = 0; j < n; ++j)
+                {
+                    const int s = scales[j] < numScales ? scales[j] : 0;
+                    const bool present = voice < 3 || qualities[j] >= minQuality || (exts[j] & extBit) != 0;
+                    v[(size_t) voice][(size_t) j] = present ? roots[j] + offsets[(size_t) s][(size_t) voice] : absent;
+                }
+            }
+
+            for (int j = 0; j < n; ++j)
+            {
+                int c = 0;
+                for (int voice = 0; voice < numVoices; ++voice)
+                    c += v[(size_t) voice][(size_t) j] < absentLimit ? 1 : 0;
+                count[(size_t) j] = c;
+            }
+
+            // Inversión: sube una octava las primeras min(inversion, tamaño - 1) voces
+            for (int voice = 0; voice < maxTileInversion; ++voice)
+                for (int j = 0; j < n; ++j)
+                    v[(size_t) voice][(size_t) j] += voice < juce::jmin((int) invs[j], count[(size_t) j] - 1) ? 12 : 0;
+
+            // Ajuste de rango (48–84): mismas iteraciones que el camino escalar, por máscaras.
+            // Cuando ningún acorde del tile se mueve las iteraciones restantes no cambiarían nada.
+            for (int iter = 0; iter < 8; ++iter)
+            {
+                int* l = lo.data();
+                int* h = hi.data();
+                int* sh = shift.data();
+
+                std::copy(v[0].begin(), v[0].begin() + n, l);
+                std::fill(h, h + n, std::numeric_limits<int>::min());
+                for (int voice = 0; voice < numVoices; ++voice)
+                {
+                    const int* column = v[(size_t) voice].data();
+                    for (int j = 0; j < n; ++j)
+                    {
+                        const int x = column[j];
+                        l[j] = x < l[j] ? x : l[j];
+                        const int top = x < absentLimit ? x : std::numeric_limits<int>::min();
+                        h[j] = top > h[j] ? top : h[j];
+                    }
+                }
+
+                int anyShift = 0;
+                for (int j = 0; j < n; ++j)
+                {
+                    const int up   = l[j] < 48;
+                    const int down = h[j] > 84;
+                    sh[j] = 12 * up - 12 * (down & (up ^ 1));
+                    anyShift |= sh[j];
+                }
+                if (anyShift == 0)
+                    break;
+
+                for (int voice = 0; voice < numVoices; ++voice)
+                {
+                    int* column = v[(size_t) voice].data();
+                    for (int j = 0; j < n; ++j)
+                        column[j] += sh[j];
+                }
+            }
+
+            // Orden ascendente; las voces ausentes quedan al final
+            for (const auto& [a, b] : sortNetwork7)
+            {
+                int* va = v[(size_t) a].data();
+                int* vb = v[(size_t) b].data();
+                for (int j = 0; j < n; ++j)
+                {
+                    const int x = va[j], y = vb[j];
+                    va[j] = x < y ? x : y;
+                    vb[j] = x < y ? y : x;
+                }
+            }
+
+            for (int voice = 0; voice < numVoices; ++voice)
+                std::copy(v[(size_t) voice].begin(), v[(size_t) voice].begin() + n, batch.notes[(size_t) voice].begin() + base);
+            for (int j = 0; j < n; ++j)
+                batch.sizes[(size_t) (base + j)] = (juce::uint8) count[(size_t) j];
+
+            // Inversiones fuera de rango del tile (no alcanzables desde los parámetros): camino escalar
+            for (int j = 0; j < n; ++j)
+            {
+                if (invs[j] <= maxTileInversion)
+                    continue;
+
+                ChordNotes chord;
+                const ExtensionToggles toggles { (exts[j] & ChordBatch::add7Bit) != 0, (exts[j] & ChordBatch::add9Bit) != 0,
+                                                 (exts[j] & ChordBatch::add11Bit) != 0, (exts[j] & ChordBatch::add13Bit) != 0 };
+                makeChordNotes(roots[j], (ScaleType) scales[j], (ChordQuality) qualities[j], invs[j], toggles, chord);
+                for (int voice = 0; voice < chord.size; ++voice)
+                    batch.notes[(size_t) voice][(size_t) (base + j)] = chord.notes[(size_t) voice];
+            }
+        }
+    }
+}
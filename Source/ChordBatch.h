@@ -0,0 +1,41 @@
+// ChordBatch.h
+// Generación masiva de acordes en estructura de arrays (exportación, previsualización, procesos offline)
+
+#pragma once
+
+#include <juce_core/juce_core.h>
+#include <array>
+#include <vector>
+#include "Parameters.h"
+#include "Theory.h"
+
+namespace cc
+{
+    // Lote de acordes en formato SoA: una columna por campo de entrada y una por voz de salida.
+    // makeChordNotesBatch produce exactamente lo mismo que makeChordNotes acorde a acorde.
+    struct ChordBatch
+    {
+        // Bits de 'extensions'
+        enum : juce::uint8 { add7Bit = 1, add9Bit = 2, add11Bit = 4, add13Bit = 8 };
+
+        // Entrada
+        std::vector<int> roots;
+        std::vector<juce::uint8> scales;      // ScaleType
+        std::vector<juce::uint8> qualities;   // ChordQuality
+        std::vector<juce::uint8> inversions;
+        std::vector<juce::uint8> extensions;  // add7Bit | add9Bit | ...
+
+        // Salida: notes[voz][acorde], ascendente; las voces >= sizes[acorde] no se usan
+        std::array<std::vector<int>, ChordNotes::maxNotes> notes;
+        std::vector<juce::uint8> sizes;
+
+        void resize(int numChords);
+        int size() const { return (int) roots.size(); }
+
+        void set(int index, int root, ScaleType scale, ChordQuality quality, int inversion, const ExtensionToggles& toggles);
+        void get(int index, ChordNotes& out) const;
+    };
+
+    // Resuelve todos los acordes del lote
+    void makeChordNotesBatch(ChordBatch& batch);
+}
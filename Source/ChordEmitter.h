@@ -0,0 +1,141 @@
+// ChordEmitter.h
+// Núcleos de emisión de acordes especializados por plantilla y tabla de despacho por bloque
+
+#pragma once
+
+#include <juce_core/juce_core.h>
+#include <array>
+#include <utility>
+#include "Parameters.h"
+#include "Theory.h"
+#include "Patterns.h"
+#include "FastRandom.h"
+
+namespace cc
+{
+    // Parámetros de un acorde a emitir (samples o ticks, según el consumidor)
+    struct ChordEmitParams
+    {
+        juce::int64 earliest = 0;  // ningún note-on antes de este instante
+        juce::int64 start = 0;     // inicio del acorde (ya desplazado por el look-ahead)
+        juce::int64 length = 0;
+        juce::int64 step = 0;
+        juce::int64 strum = 0;
+        int ratchet = 1;
+        PatternMode pattern = PatternMode::Block;
+
+        int velocity = 96;
+        int humanizeSamples = 0;
+        int humanizeVel = 0;
+
+        // Sincronía con el host: el inicio se cuantiza a la rejilla; hacia atrás como mucho maxEarly
+        double ppq = 0.0;
+        double gridQN = 1.0;
+        double samplesPerQN = 1.0;
+        int maxEarly = 0;
+    };
+
+    // Memoria de trabajo reutilizada entre acordes
+    struct ChordEmitScratch
+    {
+        PatternNotes& pattern;
+        HumanizeBatch& humanize;
+        FastRandom& rng;
+    };
+
+    // Rasgos que cambian el bucle interno. Se fijan una vez por bloque (o tras un cambio automatizado).
+    struct ChordEmitFlags
+    {
+        bool humanize = false;    // humanizeMs o humanizeVel > 0
+        bool extensions = false;  // calidad > tríada o alguna extensión: acordes de más de 3 notas
+        bool patterned = false;   // strum/arpegio: requiere expandir el patrón
+        bool hostSync = false;    // cuantización a la rejilla del host
+
+        int index() const noexcept
+        {
+            return (humanize ? 1 : 0) | (extensions ? 2 : 0) | (patterned ? 4 : 0) | (hostSync ? 8 : 0);
+        }
+    };
+
+    inline bool chordHasExtensions(ChordQuality quality, const ExtensionToggles& t) noexcept
+    {
+        return quality != ChordQuality::Triad || t.add7 || t.add9 || t.add11 || t.add13;
+    }
+
+    // Sink: bool reserve(int numEvents); void note(int64 on, int64 off, int note, int velocity)
+    template <typename Sink>
+    using ChordEmitFn = int (*)(const ChordEmitParams&, const ChordNotes&, ChordEmitScratch&, Sink&);
+
+    // Emite un acorde. Devuelve el número de notas emitidas (0 si el sink no tenía presupuesto).
+    // La combinación habitual (sin humanizar, tríada, bloque, sin rejilla) queda en un bucle de 3
+    // iteraciones sin ramas ni llamadas al generador aleatorio.
+    template <bool Humanize, bool Extensions, bool Patterned, bool HostSync, typename Sink>
+    int emitChord(const ChordEmitParams& p, const ChordNotes& chord, ChordEmitScratch& s, Sink& sink)
+    {
+        juce::int64 start = p.start;
+        if constexpr (HostSync)
+        {
+            const double target = std::round(p.ppq / p.gridQN) * p.gridQN;
+            start += juce::jmax(-p.maxEarly, (int) std::llround((target - p.ppq) * p.samplesPerQN));
+        }
+
+        int numNotes = 0;
+        if constexpr (Patterned)
+        {
+            const PatternTiming timing { start, p.length, p.step, p.strum, p.ratchet };
+            numNotes = expandPattern(p.pattern, chord, timing, s.pattern);
+        }
+        else
+        {
+            numNotes = Extensions ? chord.size : juce::jmin(3, chord.size);
+        }
+
+        if (numNotes == 0 || ! sink.reserve(2 * numNotes))
+            return 0;
+
+        if constexpr (Humanize)
+            s.humanize.generate(s.rng, numNotes, p.humanizeSamples, p.velocity, p.humanizeVel);
+
+        const int velocity = juce::jlimit(1, 127, p.velocity);
+        const juce::int64 end = start + juce::jmax((juce::int64) 1, p.length);
+
+        for (int i = 0; i < numNotes; ++i)
+        {
+            // Bloque: todas las voces de start a end (mismo resultado que expandPattern)
+            const int note        = Patterned ? s.pattern[(size_t) i].note : chord.notes[(size_t) i];
+            const juce::int64 on  = Patterned ? s.pattern[(size_t) i].on   : start;
+            const juce::int64 off = Patterned ? s.pattern[(size_t) i].off  : end;
+
+            if constexpr (Humanize)
+            {
+                const juce::int64 onTime = juce::jmax(p.earliest, on + s.humanize.onOffsets[(size_t) i]);
+                sink.note(onTime, juce::jmax(onTime + 1, off + s.humanize.offOffsets[(size_t) i]),
+                          note, s.humanize.velocities[(size_t) i]);
+            }
+            else
+            {
+                const juce::int64 onTime = juce::jmax(p.earliest, on);
+                sink.note(onTime, juce::jmax(onTime + 1, off), note, velocity);
+            }
+        }
+
+        return numNotes;
+    }
+
+    namespace detail
+    {
+        template <typename Sink, size_t... I>
+        constexpr std::array<ChordEmitFn<Sink>, sizeof...(I)> makeChordEmitTable(std::index_sequence<I...>)
+        {
+            return { &emitChord<(I & 1) != 0, (I & 2) != 0, (I & 4) != 0, (I & 8) != 0, Sink>... };
+        }
+    }
+
+    // Selecciona la instanciación adecuada para los rasgos dados
+    template <typename Sink>
+    ChordEmitFn<Sink> selectChordEmitter(const ChordEmitFlags& flags) noexcept
+    {
+        static constexpr auto table = detail::makeChordEmitTable<Sink>(std::make_index_sequence<16>());
+        return table[(size_t) flags.index()];
+    }
+}
@@ -0,0 +1,56 @@
+// ChordMailbox.h
+// Último acorde en vivo para la UI: el hilo de audio lo publica sin asignaciones ni listeners
+// (seqlock sobre atómicos) y el editor lo formatea en su timer.
+
+#pragma once
+
+#include <juce_core/juce_core.h>
+#include <array>
+#include <atomic>
+#include "Theory.h"
+
+namespace cc
+{
+    // Un escritor (hilo de audio) y cualquier número de lectores
+    class ChordMailbox
+    {
+    public:
+        void publish(const ChordNotes& chord) noexcept
+        {
+            const auto seq = sequence.load(std::memory_order_relaxed);
+            sequence.store(seq + 1, std::memory_order_relaxed);  // impar: escritura en curso
+            std::atomic_thread_fence(std::memory_order_release);
+
+            numNotes.store(chord.size, std::memory_order_relaxed);
+            for (int i = 0; i < chord.size; ++i)
+                notes[(size_t) i].store((juce::int8) chord.notes[(size_t) i], std::memory_order_relaxed);
+
+            sequence.store(seq + 2, std::memory_order_release);
+        }
+
+        // Devuelve la versión leída (0 = nada publicado todavía o escritura en curso)
+        juce::uint32 read(ChordNotes& out) const noexcept
+        {
+            const auto before = sequence.load(std::memory_order_acquire);
+            if (before == 0 || (before & 1) != 0)
+                return 0;
+
+            ChordNotes chord;
+            chord.size = juce::jlimit(0, ChordNotes::maxNotes, numNotes.load(std::memory_order_relaxed));
+            for (int i = 0; i < chord.size; ++i)
+                chord.notes[(size_t) i] = notes[(size_t) i].load(std::memory_order_relaxed);
+
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (sequence.load(std::memory_order_relaxed) != before)
+                return 0;
+
+            out = chord;
+            return before;
+        }
+
+    private:
+        std::atomic<juce::uint32> sequence { 0 };
+        std::atomic<int> numNotes { 0 };
+        std::array<std::atomic<juce::int8>, ChordNotes::maxNotes> notes {};
+    };
+}
@@ -0,0 +1,59 @@
+// CommandQueue.h
+// Órdenes del editor al hilo de audio: FIFO sin bloqueos (un productor, un consumidor)
+
+#pragma once
+
+#include <juce_core/juce_core.h>
+#include <array>
+
+namespace cc
+{
+    struct Command
+    {
+        enum class Type : juce::uint8
+        {
+            Generate,  // construye la cola desde el plan y la reproduce
+            Stop,      // detiene la cola y apaga sus notas
+            Audition,  // toca una vez el acorde del paso 'value' (-1 = paso actual)
+            Reseed     // resiembra la humanización con 'value' (0 = semilla no reproducible)
+        };
+
+        Type type = Type::Generate;
+        int value = 0;
+    };
+
+    // Productor: hilo de mensajes (push). Consumidor: hilo de audio (drain, al principio del bloque).
+    // Ni el audio notifica al host ni el editor toca el estado del motor: todo pasa por aquí.
+    class CommandQueue
+    {
+    public:
+        static constexpr int capacity = 64;
+
+        // false si la cola está llena (la orden se descarta)
+        bool push(const Command& c) noexcept
+        {
+            int start1, size1, start2, size2;
+            fifo.prepareToWrite(1, start1, size1, start2, size2);
+            if (size1 + size2 == 0)
+                return false;
+
+            slots[(size_t) (size1 > 0 ? start1 : start2)] = c;
+            fifo.finishedWrite(1);
+            return true;
+        }
+
+        template <typename Handler>
+        void drain(Handler&& handle) noexcept
+        {
+            int start1, size1, start2, size2;
+            fifo.prepareToRead(fifo.getNumReady(), start1, size1, start2, size2);
+            for (int i = 0; i < size1; ++i) handle(slots[(size_t) (start1 + i)]);
+            for (int i = 0; i < size2; ++i) handle(slots[(size_t) (start2 + i)]);
+            fifo.finishedRead(size1 + size2);
+        }
+
+    private:
+        juce::AbstractFifo fifo { capacity };
+        std::array<Command, capacity> slots {};
+    };
+}
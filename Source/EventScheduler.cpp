@@ -0,0 +1,148 @@
+// EventScheduler.cpp
+
+#include "EventScheduler.h"
+
+namespace cc
+{
+    bool EventScheduler::add(juce::int64 time, const juce::MidiMessage& msg)
+    {
+        return add(time, msg, false);
+    }
+
+    bool EventScheduler::add(juce::int64 time, const juce::MidiMessage& msg, bool paired)
+    {
+        if (msg.getRawDataSize() > 3)
+        {
+            ++dropped;
+            return false;
+        }
+
+        const bool noteOff = msg.isNoteOff();
+        if (count >= (noteOff ? capacity : capacity - noteOffReserve)
+            && ! (noteOff && evictLatestNote()))
+        {
+            ++dropped;
+            return false;
+        }
+
+        Event e;
+        e.time = time;
+        e.order = nextOrder++;
+        e.priority = noteOff ? 0 : (msg.isNoteOn() ? 2 : 1);
+        e.paired = paired && e.priority == 2;
+        e.size = (juce::uint8) msg.getRawDataSize();
+        std::memcpy(e.data, msg.getRawData(), e.size);
+        push(e);
+        return true;
+    }
+
+    bool EventScheduler::addNote(juce::int64 onTime, juce::int64 offTime, int channel, int note, int velocity)
+    {
+        if (getFreeSpace() < 2)
+        {
+            dropped += 2;
+            return false;
+        }
+
+        add(onTime,  juce::MidiMessage::noteOn(channel, note, (juce::uint8) juce::jlimit(1, 127, velocity)), true);
+        add(offTime, juce::MidiMessage::noteOff(channel, note), false);
+        return true;
+    }
+
+    bool EventScheduler::evictLatestNote()
+    {
+        // Solo con la cola llena de verdad (reserva agotada): recorrido lineal.
+        // Se prefieren notas de addNote: su note-off se conoce y sale con ellas, así no queda un note-off suelto
+        // que corte otra nota de la misma altura. Un note-on ligado (legato) recibe su note-off más tarde; solo se
+        // descarta si no queda otra cosa, porque perder el note-off entrante dejaría una nota colgada.
+        int victim = -1;
+        for (int i = 0; i < count; ++i)
+        {
+            const auto& e = heap[(size_t) i];
+            if (e.priority != 2)
+                continue;
+
+            if (victim < 0)
+            {
+                victim = i;
+                continue;
+            }
+
+            const auto& v = heap[(size_t) victim];
+            if (e.paired != v.paired ? e.paired : earlier(v, e))
+                victim = i;
+        }
+        if (victim < 0)
+            return false;
+
+        const auto on = heap[(size_t) victim];
+        removeAt(victim);
+        ++dropped;
+        if (! on.paired)
+            return true;
+
+        for (int i = 0; i < count; ++i)
+        {
+            const auto& e = heap[(size_t) i];
+            if (e.order == on.order + 1 && e.priority == 0 && e.data[1] == on.data[1]
+                && (e.data[0] & 0x0f) == (on.data[0] & 0x0f))
+            {
+                removeAt(i);
+                ++dropped;
+                break;
+            }
+        }
+        return true;
+    }
+
+    void EventScheduler::push(const Event& e)
+    {
+        heap[(size_t) count] = e;
+        siftUp(count++);
+    }
+
+    EventScheduler::Event EventScheduler::pop()
+    {
+        const Event top = heap[0];
+        removeAt(0);
+        return top;
+    }
+
+    void EventScheduler::removeAt(int index)
+    {
+        heap[(size_t) index] = heap[(size_t) --count];
+        if (index < count)
+        {
+            siftUp(index);
+            siftDown(index);
+        }
+    }
+
+    void EventScheduler::siftUp(int i)
+    {
+        while (i > 0)
+        {
+            const int parent = (i - 1) / 2;
+            if (! earlier(heap[(size_t) i], heap[(size_t) parent]))
+                break;
+            std::swap(heap[(size_t) i], heap[(size_t) parent]);
+            i = parent;
+        }
+    }
+
+    void EventScheduler::siftDown(int i)
+    {
+        for (;;)
+        {
+            const int l = 2 * i + 1;
+            const int r = l + 1;
+            int best = i;
+            if (l < count && earlier(heap[(size_t) l], heap[(size_t) best])) best = l;
+            if (r < count && earlier(heap[(size_t) r], heap[(size_t) best])) best = r;
+            if (best == i)
+                break;
+            std::swap(heap[(size_t) i], heap[(size_t) best]);
+            i = best;
+        }
+    }
+}
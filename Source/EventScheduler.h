@@ -0,0 +1,94 @@
+// EventScheduler.h
+// Cola de eventos MIDI pendientes en tiempo absoluto (samples): capacidad fija, sin asignaciones
+
+#pragma once
+
+#include <juce_audio_basics/juce_audio_basics.h>
+#include <array>
+#include <utility>
+#include "BlockEventList.h"
+
+namespace cc
+{
+    // Min-heap de eventos ordenados por tiempo absoluto. Permite programar notas que caen
+    // muchos bloques después (patrones, note-offs) con independencia del tamaño de bloque.
+    // Los note-offs nunca se pierden: tienen huecos reservados y, si aun así la cola está llena,
+    // se descarta la nota pendiente (note-on + su note-off) que empieza más tarde.
+    class EventScheduler
+    {
+    public:
+        static constexpr int capacity = 4096;
+        static constexpr int noteOffReserve = 512;  // huecos que solo pueden ocupar note-offs
+
+        EventScheduler() = default;
+
+        void clear() { count = 0; nextOrder = 0; }
+        int getNumPending() const { return count; }
+        int getFreeSpace() const  { return capacity - noteOffReserve - count; }
+
+        // Añade un evento de hasta 3 bytes. Devuelve false si no cabe (un note-off siempre cabe
+        // mientras quede algún note-on pendiente que descartar).
+        bool add(juce::int64 time, const juce::MidiMessage& msg);
+
+        // Añade note-on + note-off solo si caben ambos (nunca deja notas colgadas)
+        bool addNote(juce::int64 onTime, juce::int64 offTime, int channel, int note, int velocity);
+
+        // Eventos descartados (rechazados o desalojados) desde la última llamada
+        int takeDropped() noexcept { return std::exchange(dropped, 0); }
+
+        // Emite en out los eventos con tiempo < blockStart + numSamples.
+        // Los eventos atrasados (tiempo < blockStart) se emiten en la posición 0.
+        // Si 'out' se llena, el resto espera al bloque siguiente.
+        void emitBlock(BlockEventList& out, juce::int64 blockStart, int numSamples)
+        {
+            emitBlock(out, blockStart, numSamples, [](const juce::uint8*, int) { return true; });
+        }
+
+        // Igual, pero solo se añaden los eventos para los que accept(data, size) devuelve true
+        // (los rechazados también salen de la cola)
+        template <typename Filter>
+        void emitBlock(BlockEventList& out, juce::int64 blockStart, int numSamples, Filter&& accept)
+        {
+            const juce::int64 blockEnd = blockStart + numSamples;
+            while (count > 0 && heap[0].time < blockEnd && ! out.isFull())
+            {
+                const auto e = pop();
+                if (! accept(e.data, (int) e.size))
+                    continue;
+                const int pos = (int) juce::jmax((juce::int64) 0, e.time - blockStart);
+                out.add(pos, e.data, e.size);
+            }
+        }
+
+    private:
+        struct Event
+        {
+            juce::int64 time = 0;
+            juce::uint32 order = 0;    // desempate FIFO entre eventos del mismo tiempo y prioridad
+            juce::uint8 priority = 0;  // note-off < otros < note-on en el mismo sample
+            bool paired = false;       // note-on de addNote: su note-off es el evento con order + 1
+            juce::uint8 size = 0;
+            juce::uint8 data[3] {};
+        };
+
+        static bool earlier(const Event& a, const Event& b)
+        {
+            if (a.time != b.time)         return a.time < b.time;
+            if (a.priority != b.priority) return a.priority < b.priority;
+            return a.order < b.order;
+        }
+
+        bool add(juce::int64 time, const juce::MidiMessage& msg, bool paired);
+        void push(const Event& e);
+        Event pop();
+        void removeAt(int index);
+        void siftUp(int index);
+        void siftDown(int index);
+        bool evictLatestNote();
+
+        std::array<Event, capacity> heap {};
+        int count = 0;
+        juce::uint32 nextOrder = 0;
+        int dropped = 0;
+    };
+}
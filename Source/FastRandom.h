@@ -0,0 +1,107 @@
+// FastRandom.h
+// Generador pseudoaleatorio rápido y sembrable (xoshiro256**) y humanización por lotes
+
+#pragma once
+
+#include <juce_core/juce_core.h>
+#include <array>
+
+namespace cc
+{
+    // xoshiro256** (Blackman/Vigna): estado de 256 bits, sin asignaciones y reproducible con la misma semilla
+    class FastRandom
+    {
+    public:
+        FastRandom() { seedFromClock(); }
+        explicit FastRandom(juce::uint64 seed) { setSeed(seed); }
+
+        // Expande la semilla con splitmix64 (evita estados degenerados, p.ej. semilla 0)
+        void setSeed(juce::uint64 seed)
+        {
+            for (auto& word : s)
+            {
+                seed += 0x9e3779b97f4a7c15ull;
+                juce::uint64 z = seed;
+                z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+                z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+                word = z ^ (z >> 31);
+            }
+        }
+
+        // Semilla no reproducible (reloj + dirección de la instancia)
+        void seedFromClock()
+        {
+            setSeed((juce::uint64) juce::Time::getHighResolutionTicks()
+                    ^ (juce::uint64) reinterpret_cast<juce::pointer_sized_uint>(this));
+        }
+
+        juce::uint64 next() noexcept
+        {
+            const juce::uint64 result = rotl(s[1] * 5, 7) * 9;
+            const juce::uint64 t = s[1] << 17;
+            s[2] ^= s[0];
+            s[3] ^= s[1];
+            s[1] ^= s[2];
+            s[0] ^= s[3];
+            s[2] ^= t;
+            s[3] = rotl(s[3], 45);
+            return result;
+        }
+
+        // Entero uniforme en [-maxAbs, maxAbs] (multiplicación+desplazamiento, sin división)
+        int nextSymmetric(int maxAbs) noexcept
+        {
+            return mapSymmetric((juce::uint32) (next() >> 32), maxAbs);
+        }
+
+        static int mapSymmetric(juce::uint32 r, int maxAbs) noexcept
+        {
+            const auto span = (juce::uint64) (2 * juce::jmax(0, maxAbs) + 1);
+            return (int) (((juce::uint64) r * span) >> 32) - maxAbs;
+        }
+
+    private:
+        static juce::uint64 rotl(juce::uint64 x, int k) noexcept { return (x << k) | (x >> (64 - k)); }
+
+        std::array<juce::uint64, 4> s {};
+    };
+
+    // Desplazamientos y velocidades humanizados para un acorde completo.
+    // Se sacan todos los números aleatorios de una vez y se mapean en bucles sin ramas (vectorizables).
+    struct HumanizeBatch
+    {
+        static constexpr int maxNotes = 256;
+
+        std::array<int, maxNotes> onOffsets {};
+        std::array<int, maxNotes> offOffsets {};
+        std::array<int, maxNotes> velocities {};
+
+        void generate(FastRandom& rng, int numNotes, int maxOffsetSamples, int baseVelocity, int maxVelocityDelta)
+        {
+            const int n = juce::jlimit(0, maxNotes, numNotes);
+            const int range = juce::jmax(0, maxOffsetSamples);
+            const int velDelta = juce::jmax(0, maxVelocityDelta);
+
+            // Cada next() de 64 bits aporta dos valores de 32 bits: uno para on y otro para off
+            for (int i = 0; i < n; ++i)
+            {
+                const juce::uint64 r = rng.next();
+                rawOn[(size_t) i]  = (juce::uint32) (r >> 32);
+                rawOff[(size_t) i] = (juce::uint32) r;
+            }
+            for (int i = 0; i < n; ++i)
+                rawVel[(size_t) i] = (juce::uint32) (rng.next() >> 32);
+
+            for (int i = 0; i < n; ++i)
+            {
+                onOffsets[(size_t) i]  = FastRandom::mapSymmetric(rawOn[(size_t) i], range);
+                offOffsets[(size_t) i] = FastRandom::mapSymmetric(rawOff[(size_t) i], range);
+            }
+            for (int i = 0; i < n; ++i)
+                velocities[(size_t) i] = juce::jlimit(1, 127, baseVelocity + FastRandom::mapSymmetric(rawVel[(size_t) i], velDelta));
+        }
+
+    private:
+        std::array<juce::uint32, maxNotes> rawOn {}, rawOff {}, rawVel {};
+    };
+}
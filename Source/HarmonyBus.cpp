@@ -0,0 +1,64 @@
+// HarmonyBus.cpp
+
+#include "HarmonyBus.h"
+
+namespace cc
+{
+    HarmonyBus& HarmonyBus::get()
+    {
+        static HarmonyBus bus;
+        return bus;
+    }
+
+    bool HarmonyBus::publish(const HarmonySnapshot& s) noexcept
+    {
+        // Reclama la escritura pasando la secuencia a impar; con dos líderes a la vez uno cede
+        auto seq = state.sequence.load(std::memory_order_relaxed);
+        if ((seq & 1) != 0 || ! state.sequence.compare_exchange_strong(seq, seq + 1, std::memory_order_relaxed))
+            return false;
+        std::atomic_thread_fence(std::memory_order_release);
+
+        state.key.store(s.key, std::memory_order_relaxed);
+        state.scale.store(s.scale, std::memory_order_relaxed);
+        state.degree.store(s.degree, std::memory_order_relaxed);
+        state.numNotes.store(s.chord.size, std::memory_order_relaxed);
+        for (int i = 0; i < s.chord.size; ++i)
+            state.notes[(size_t) i].store((juce::int8) s.chord.notes[(size_t) i], std::memory_order_relaxed);
+        state.chordId.store(s.chordId, std::memory_order_relaxed);
+        state.heartbeatMs.store(s.heartbeatMs, std::memory_order_relaxed);
+
+        state.sequence.store(seq + 2, std::memory_order_release);
+        return true;
+    }
+
+    bool HarmonyBus::read(HarmonySnapshot& out) const noexcept
+    {
+        for (int attempt = 0; attempt < maxReadAttempts; ++attempt)
+        {
+            const auto before = state.sequence.load(std::memory_order_acquire);
+            if ((before & 1) != 0)
+                continue;
+
+            HarmonySnapshot s;
+            s.key = state.key.load(std::memory_order_relaxed);
+            s.scale = state.scale.load(std::memory_order_relaxed);
+            s.degree = state.degree.load(std::memory_order_relaxed);
+            s.chord.size = juce::jlimit(0, ChordNotes::maxNotes, state.numNotes.load(std::memory_order_relaxed));
+            for (int i = 0; i < s.chord.size; ++i)
+                s.chord.notes[(size_t) i] = state.notes[(size_t) i].load(std::memory_order_relaxed);
+            s.chordId = state.chordId.load(std::memory_order_relaxed);
+            s.heartbeatMs = state.heartbeatMs.load(std::memory_order_relaxed);
+
+            // Si la secuencia no ha cambiado, nada de lo leído es de una escritura a medias
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (state.sequence.load(std::memory_order_relaxed) != before)
+                continue;
+
+            if (before == 0)
+                return false;
+            out = s;
+            return true;
+        }
+        return false;
+    }
+}
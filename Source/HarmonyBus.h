@@ -0,0 +1,55 @@
+// HarmonyBus.h
+// Bus de armonía compartido por todas las instancias del proceso: un líder publica tonalidad, escala,
+// grado y notas de su acorde actual en cada bloque; los seguidores lo leen sin bloqueos ni asignaciones
+// y construyen sus propias voces. Seqlock sobre atómicos: los lectores no escriben nada compartido.
+
+#pragma once
+
+#include <juce_core/juce_core.h>
+#include <array>
+#include <atomic>
+#include "Theory.h"
+
+namespace cc
+{
+    struct HarmonySnapshot
+    {
+        int key = 0, scale = 0;
+        int degree = 0;              // 1..7; 0 = el líder no publica armonía
+        ChordNotes chord;            // voz del líder (referencia: el seguidor usa la suya)
+        juce::uint32 chordId = 0;    // cambia con cada cambio de acorde del líder
+        juce::uint32 heartbeatMs = 0;
+
+        // Un líder que deja de procesar bloques (bypass, borrado) se da por perdido
+        static constexpr juce::uint32 staleAfterMs = 500;
+        bool isLive(juce::uint32 nowMs) const noexcept { return degree > 0 && nowMs - heartbeatMs < staleAfterMs; }
+    };
+
+    class HarmonyBus
+    {
+    public:
+        static HarmonyBus& get();
+
+        // Líder (hilo de audio). Si otro líder está publicando en ese instante no se espera: se omite
+        // este bloque y devuelve false.
+        bool publish(const HarmonySnapshot& s) noexcept;
+
+        // Seguidores (cualquier hilo): como mucho maxReadAttempts intentos, así que nunca espera a un
+        // escritor. false si no hubo lectura consistente o nadie ha publicado todavía.
+        bool read(HarmonySnapshot& out) const noexcept;
+
+    private:
+        static constexpr int maxReadAttempts = 4;
+
+        // Todo en una línea de caché: los lectores la comparten sin invalidarse entre ellos
+        struct alignas(64) State
+        {
+            std::atomic<juce::uint32> sequence { 0 };  // impar = escritura en curso
+            std::atomic<int> key { 0 }, scale { 0 }, degree { 0 }, numNotes { 0 };
+            std::array<std::atomic<juce::int8>, ChordNotes::maxNotes> notes {};
+            std::atomic<juce::uint32> chordId { 0 }, heartbeatMs { 0 };
+        };
+
+        State state;
+    };
+}
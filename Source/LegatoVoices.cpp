@@ -0,0 +1,30 @@
+// LegatoVoices.cpp
+
+#include "LegatoVoices.h"
+
+namespace cc
+{
+    bool LegatoVoices::noteOn(int note, juce::int64 off) noexcept
+    {
+        note &= 0x7f;
+        auto& until = heldUntil[(size_t) note];
+        const bool tie = until != notHeld && until >= tieFrom;
+
+        until = tie ? juce::jmax(until, off) : off;
+        reused[(size_t) note] = true;
+        return ! tie;
+    }
+
+    void LegatoVoices::endChord(bool played) noexcept
+    {
+        if (! played)
+            return;
+
+        for (int note = 0; note < 128; ++note)
+        {
+            auto& until = heldUntil[(size_t) note];
+            if (! reused[(size_t) note] && until != notHeld && until > chordTime)
+                until = chordTime;
+        }
+    }
+}
@@ -0,0 +1,74 @@
+// LegatoVoices.h
+// Modo legato: las notas comunes entre acordes consecutivos se mantienen (sin note-off + note-on)
+
+#pragma once
+
+#include <juce_core/juce_core.h>
+#include <array>
+
+namespace cc
+{
+    // Conjunto de notas retenidas de un canal, con el instante en que deben soltarse.
+    // Uso por acorde: beginChord(t, tol) -> noteOn(...) por nota -> endChord(). Los note-off no se programan al
+    // emitir la nota: los entrega release*() cuando se conoce su final definitivo.
+    //  - nota que sigue sonando en t - tol y vuelve a aparecer: se liga (sin note-on) y su final se alarga
+    //  - nota retenida que no vuelve a aparecer y sonaría más allá de t: se corta en t (sin solapes)
+    // 'tol' es el margen de humanización: un note-on adelantado nunca cae antes del note-off de la misma nota.
+    class LegatoVoices
+    {
+    public:
+        LegatoVoices() { reset(); }
+
+        void reset() noexcept
+        {
+            heldUntil.fill(notHeld);
+            reused.fill(false);
+            chordTime = tieFrom = 0;
+        }
+
+        // Suelta primero las notas que terminan antes de 'time - tolerance' (no pueden ligarse)
+        template <typename Release>
+        void beginChord(juce::int64 time, juce::int64 tolerance, Release&& release)
+        {
+            tieFrom = time - juce::jmax((juce::int64) 0, tolerance);
+            releaseBefore(tieFrom, release);
+            chordTime = time;
+            reused.fill(false);
+        }
+
+        // true si hay que emitir el note-on; false si la nota queda ligada a la anterior
+        bool noteOn(int note, juce::int64 off) noexcept;
+
+        // 'played' = false si el acorde no llegó a sonar (p.ej. sin presupuesto): no corta nada
+        void endChord(bool played) noexcept;
+
+        // release(time, note) para cada nota que termina antes de 'time'
+        template <typename Release>
+        void releaseBefore(juce::int64 time, Release&& release)
+        {
+            for (int note = 0; note < 128; ++note)
+            {
+                auto& until = heldUntil[(size_t) note];
+                if (until != notHeld && until < time)
+                {
+                    release(until, note);
+                    until = notHeld;
+                }
+            }
+        }
+
+        template <typename Release>
+        void releaseAll(Release&& release)
+        {
+            releaseBefore(std::numeric_limits<juce::int64>::max(), release);
+        }
+
+    private:
+        static constexpr juce::int64 notHeld = std::numeric_limits<juce::int64>::min();
+
+        std::array<juce::int64, 128> heldUntil {};
+        std::array<bool, 128> reused {};
+        juce::int64 chordTime = 0;
+        juce::int64 tieFrom = 0;    // notas retenidas hasta aquí o más tarde se ligan
+    };
+}
@@ -0,0 +1,125 @@
+// MidiClockSync.cpp
+
+#include "MidiClockSync.h"
+
+namespace cc
+{
+    void MidiClockSync::prepare(double newSampleRate)
+    {
+        sampleRate = newSampleRate;
+        reset();
+    }
+
+    void MidiClockSync::reset()
+    {
+        phase = 0.0;
+        period = sampleRate * 60.0 / (120.0 * ticksPerQuarter);
+        lastTickTime = 0;
+        hasTicks = false;
+        hasEstimate = false;
+        acquired = 0;
+        tickIndex = -1;
+        running = false;
+    }
+
+    void MidiClockSync::processBlock(const juce::MidiBuffer& midi, juce::int64 blockStart)
+    {
+        for (const auto meta : midi)
+        {
+            if (meta.numBytes < 1)
+                continue;
+
+            switch (meta.data[0])
+            {
+                case 0xf8:
+                    tick(blockStart + meta.samplePosition);
+                    break;
+
+                case 0xfa: // start: el siguiente pulso es la negra 0
+                    running = true;
+                    tickIndex = -1;
+                    break;
+
+                case 0xfb: // continue: sigue desde la posición actual (o la del último song position)
+                    running = true;
+                    break;
+
+                case 0xfc:
+                    running = false;
+                    break;
+
+                case 0xf2: // song position en semicorcheas (6 pulsos); el siguiente pulso cae ahí
+                    if (meta.numBytes >= 3)
+                        tickIndex = (juce::int64) ((meta.data[2] << 7) | meta.data[1]) * 6 - 1;
+                    break;
+
+                default:
+                    break;
+            }
+        }
+    }
+
+    void MidiClockSync::startAcquisition(juce::int64 time)
+    {
+        acquireStart = time;
+        acquired = 0;
+        phase = (double) time;
+    }
+
+    void MidiClockSync::tick(juce::int64 time)
+    {
+        if (running)
+            ++tickIndex;
+
+        if (! hasTicks)
+        {
+            hasTicks = true;
+            lastTickTime = time;
+            startAcquisition(time);
+            return;
+        }
+
+        const double maxPeriod = sampleRate * 60.0 / (20.0 * ticksPerQuarter);  // por debajo de 20 bpm no hay enganche
+        if ((double) (time - lastTickTime) > maxPeriod)
+        {
+            // Reloj reanudado tras una pausa: el periodo anterior sigue siendo la mejor estimación
+            lastTickTime = time;
+            startAcquisition(time);
+            return;
+        }
+        lastTickTime = time;
+
+        // Adquisición: periodo medio de los primeros pulsos, fase sin filtrar
+        if (acquired < acquireTicks)
+        {
+            ++acquired;
+            period = (double) (time - acquireStart) / acquired;
+            hasEstimate = true;
+            phase = (double) time;
+            return;
+        }
+
+        // Lazo cerrado: el error entre el pulso recibido y el previsto corrige fase y periodo
+        const double predicted = phase + period;
+        const double error = (double) time - predicted;
+        if (std::abs(error) > resyncError * period)
+        {
+            // Cambio brusco de tempo o pulsos perdidos: volver a adquirir desde este pulso
+            startAcquisition(time);
+            return;
+        }
+        phase = predicted + alpha * error;
+        period += beta * error;
+    }
+
+    bool MidiClockSync::isLocked(juce::int64 now) const
+    {
+        return hasEstimate && (double) (now - lastTickTime) < timeoutSeconds * sampleRate;
+    }
+
+    double MidiClockSync::ppqAt(juce::int64 sampleTime) const
+    {
+        const double ticksSincePhase = juce::jlimit(-2.0, 1.0, ((double) sampleTime - phase) / period);
+        return ((double) tickIndex + ticksSincePhase) / ticksPerQuarter;
+    }
+}
@@ -0,0 +1,63 @@
+// MidiClockSync.h
+// Sincronización con reloj MIDI externo (24 pulsos por negra): PLL de segundo orden que filtra el jitter
+// de los pulsos y da tempo y posición (PPQ) con precisión de sample cuando no hay transporte del host
+
+#pragma once
+
+#include <juce_audio_basics/juce_audio_basics.h>
+
+namespace cc
+{
+    class MidiClockSync
+    {
+    public:
+        static constexpr int ticksPerQuarter = 24;
+
+        void prepare(double newSampleRate);
+        void reset();
+
+        // Lee los mensajes de reloj del bloque (0xF8 pulso, 0xFA start, 0xFB continue, 0xFC stop,
+        // 0xF2 song position). 'blockStart' es el sample absoluto del primer sample del bloque.
+        void processBlock(const juce::MidiBuffer& midi, juce::int64 blockStart);
+
+        // Tempo estimado y pulsos recientes (sin pulsos durante timeoutSeconds se pierde el enganche)
+        bool isLocked(juce::int64 now) const;
+
+        // Start/continue recibido y al menos un pulso desde entonces: la posición es válida
+        bool isRunning() const { return running && tickIndex >= 0; }
+
+        double getBpm() const { return sampleRate * 60.0 / (period * ticksPerQuarter); }
+
+        // Posición en negras en 'sampleTime', interpolada desde el último pulso filtrado. Sin pulsos nuevos
+        // se detiene un pulso más allá del último (un reloj que se corta no hace correr la posición).
+        double ppqAt(juce::int64 sampleTime) const;
+
+    private:
+        void tick(juce::int64 time);
+        void startAcquisition(juce::int64 time);
+
+        // Ganancias del lazo (fase y periodo): críticamente amortiguado, beta = alpha^2 / 4
+        static constexpr double alpha = 0.1;
+        static constexpr double beta = alpha * alpha / 4.0;
+        static constexpr int acquireTicks = ticksPerQuarter;  // pulsos promediados antes de cerrar el lazo
+        static constexpr double resyncError = 0.5;            // error (en periodos) que fuerza re-adquisición
+        static constexpr double timeoutSeconds = 0.5;
+
+        double sampleRate = 44100.0;
+
+        // Estimación: instante filtrado del pulso 'tickIndex' y periodo en samples
+        double phase = 0.0;
+        double period = 0.0;
+        juce::int64 lastTickTime = 0;
+        bool hasTicks = false;
+        bool hasEstimate = false;  // al menos dos pulsos seguidos: el periodo es del reloj, no el inicial
+
+        // Adquisición: periodo medio desde el primer pulso
+        juce::int64 acquireStart = 0;
+        int acquired = 0;
+
+        // Posición de la canción: pulsos desde el principio (-1 = esperando el primer pulso tras start)
+        juce::int64 tickIndex = -1;
+        bool running = false;
+    };
+}
@@ -0,0 +1,56 @@
+// MidiDelayLine.cpp
+
+#include "MidiDelayLine.h"
+
+namespace cc
+{
+    void MidiDelayLine::clear()
+    {
+        head = count = 0;
+        writePos = bytesInUse = 0;
+    }
+
+    bool MidiDelayLine::push(juce::int64 time, const juce::uint8* data, int numBytes)
+    {
+        // Los note-offs pueden usar la reserva; el resto se queda fuera de ella
+        const bool noteOff = numBytes == 3 && ((data[0] & 0xf0) == 0x80 || ((data[0] & 0xf0) == 0x90 && data[2] == 0));
+        const int eventLimit = noteOff ? maxEvents : maxEvents - noteOffReserve;
+        const int byteLimit  = noteOff ? maxBytes : maxBytes - noteOffReserve * 3 - 3;
+
+        // Cada mensaje se guarda contiguo: si no cabe al final, se salta al principio
+        const int padding = (writePos + numBytes > maxBytes) ? (maxBytes - writePos) : 0;
+        if (count >= eventLimit || numBytes <= 0 || bytesInUse + padding + numBytes > byteLimit)
+        {
+            ++dropped;
+            return false;
+        }
+
+        const int offset = (writePos + padding) % maxBytes;
+        std::memcpy(bytes.data() + offset, data, (size_t) numBytes);
+        writePos = (offset + numBytes) % maxBytes;
+        bytesInUse += padding + numBytes;
+
+        entries[(size_t) ((head + count) % maxEvents)] = Entry { time, offset, numBytes, padding + numBytes };
+        ++count;
+        return true;
+    }
+
+    void MidiDelayLine::emitBlock(BlockEventList& out, juce::int64 blockStart, int numSamples)
+    {
+        const juce::int64 blockEnd = blockStart + numSamples;
+        while (count > 0 && entries[(size_t) head].time < blockEnd)
+        {
+            const auto& e = entries[(size_t) head];
+            const int pos = (int) juce::jmax((juce::int64) 0, e.time - blockStart);
+            if (! out.add(pos, bytes.data() + e.offset, e.size))
+                break;
+
+            bytesInUse -= e.consumed;
+            head = (head + 1) % maxEvents;
+            --count;
+        }
+
+        if (count == 0)
+            writePos = bytesInUse = 0;
+    }
+}
@@ -0,0 +1,55 @@
+// MidiDelayLine.h
+// Línea de retardo MIDI preasignada (modo look-ahead): eventos de cualquier tamaño, sin asignaciones
+
+#pragma once
+
+#include <juce_audio_basics/juce_audio_basics.h>
+#include <array>
+#include <utility>
+#include "BlockEventList.h"
+
+namespace cc
+{
+    // FIFO de eventos con tiempo absoluto en samples. Los eventos entran ya ordenados
+    // (entrada del host + retardo constante), por lo que basta una cola circular.
+    // Una reserva que solo pueden usar los note-offs (uno por canal y nota) evita notas colgadas
+    // cuando la línea se llena.
+    class MidiDelayLine
+    {
+    public:
+        static constexpr int maxEvents = 4096;
+        static constexpr int maxBytes  = 65536;
+        static constexpr int noteOffReserve = 16 * 128;
+
+        MidiDelayLine() = default;
+
+        void clear();
+        int getNumPending() const { return count; }
+
+        // Devuelve false (y descarta el evento) si no hay espacio
+        bool push(juce::int64 time, const juce::uint8* data, int numBytes);
+
+        // Emite los eventos con tiempo < blockStart + numSamples (los atrasados, en la posición 0).
+        // Si 'out' se llena, el resto espera al bloque siguiente.
+        void emitBlock(BlockEventList& out, juce::int64 blockStart, int numSamples);
+
+        // Eventos descartados por falta de espacio desde la última llamada
+        int takeDropped() noexcept { return std::exchange(dropped, 0); }
+
+    private:
+        struct Entry
+        {
+            juce::int64 time = 0;
+            int offset = 0;     // posición en 'bytes'
+            int size = 0;
+            int consumed = 0;   // size + relleno descartado al dar la vuelta al buffer
+        };
+
+        std::array<Entry, maxEvents> entries {};
+        int head = 0, count = 0;
+
+        std::array<juce::uint8, maxBytes> bytes {};
+        int writePos = 0, bytesInUse = 0;
+        int dropped = 0;
+    };
+}
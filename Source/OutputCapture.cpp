@@ -0,0 +1,220 @@
+// OutputCapture.cpp
+
+#include "OutputCapture.h"
+
+namespace cc
+{
+    OutputCapture::OutputCapture()
+        : slots((size_t) capacity)
+    {
+    }
+
+    void OutputCapture::captureBlock(const juce::MidiBuffer& out, int numSamples, double sampleRate, double blockBpm) noexcept
+    {
+        const double samplesPerQN = sampleRate * 60.0 / juce::jmax(1.0, blockBpm);
+        const double blockQN = clock.load(std::memory_order_relaxed);
+        auto index = written.load(std::memory_order_relaxed);
+
+        for (const auto meta : out)
+        {
+            // Solo mensajes de canal: lo que tiene sentido en un clip (SysEx y reloj no)
+            if (meta.numBytes < 1 || meta.numBytes > 3 || meta.data[0] < 0x80 || meta.data[0] >= 0xf0)
+                continue;
+
+            juce::uint32 packed = (juce::uint32) meta.numBytes << 24;
+            for (int i = 0; i < meta.numBytes; ++i)
+                packed |= (juce::uint32) meta.data[i] << (8 * i);
+
+            // Reserva la ranura antes de escribirla: el lector sabe que la anterior ocupante ya no es válida
+            claimed.store(index + 1, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_release);
+
+            auto& slot = slots[(size_t) (index & (capacity - 1))];
+            slot.qn.store(blockQN + meta.samplePosition / samplesPerQN, std::memory_order_relaxed);
+            slot.message.store(packed, std::memory_order_relaxed);
+            ++index;
+        }
+
+        written.store(index, std::memory_order_release);
+        clock.store(blockQN + numSamples / samplesPerQN, std::memory_order_relaxed);
+        bpm.store(blockBpm, std::memory_order_relaxed);
+    }
+
+    double OutputCapture::snapshot(double windowQN, std::vector<CapturedEvent>& out) const
+    {
+        out.clear();
+        const double now = clock.load(std::memory_order_relaxed);
+        const auto end = written.load(std::memory_order_acquire);
+        const auto begin = end > (juce::uint64) capacity ? end - (juce::uint64) capacity : 0;
+
+        for (auto i = begin; i < end; ++i)
+        {
+            const auto& slot = slots[(size_t) (i & (capacity - 1))];
+            CapturedEvent e;
+            e.qn = slot.qn.load(std::memory_order_relaxed);
+            const auto packed = slot.message.load(std::memory_order_relaxed);
+            e.size = (int) (packed >> 24);
+            for (int b = 0; b < 3; ++b)
+                e.data[b] = (juce::uint8) (packed >> (8 * b));
+            out.push_back(e);
+        }
+
+        // Las ranuras reservadas por el escritor durante la copia pueden estar a medio sobrescribir
+        std::atomic_thread_fence(std::memory_order_acquire);
+        const auto claimedNow = claimed.load(std::memory_order_relaxed);
+        const auto firstValid = claimedNow > (juce::uint64) capacity ? claimedNow - (juce::uint64) capacity : 0;
+        if (firstValid > begin)
+            out.erase(out.begin(), out.begin() + (std::ptrdiff_t) juce::jmin((juce::uint64) out.size(), firstValid - begin));
+
+        // Ventana: solo las últimas 'windowQN' negras
+        const double from = now - windowQN;
+        auto first = std::find_if(out.begin(), out.end(), [from](const CapturedEvent& e) { return e.qn >= from; });
+        out.erase(out.begin(), first);
+        return now;
+    }
+
+    int writeCaptureAsMidi(const std::vector<CapturedEvent>& events, double endQN, double bpm, juce::OutputStream& out)
+    {
+        constexpr int ticksPerQN = 960;
+        constexpr double qnPerBar = 4.0;
+        if (events.empty())
+            return 0;
+
+        const double startQN = std::floor(events.front().qn / qnPerBar) * qnPerBar;
+        auto toTicks = [startQN](double qn) { return std::round((qn - startQN) * ticksPerQN); };
+
+        juce::MidiMessageSequence seq;
+        seq.addEvent(juce::MidiMessage::tempoMetaEvent((int) std::round(60000000.0 / juce::jmax(1.0, bpm))), 0.0);
+
+        // Notas sonando por canal y nota (varias a la vez si se re-disparan antes de soltarse)
+        std::array<std::array<juce::uint8, 128>, 16> sounding {};
+        int numNotes = 0;
+        for (const auto& e : events)
+        {
+            juce::MidiMessage msg(e.data, e.size, toTicks(e.qn));
+            const auto ch = (size_t) (msg.getChannel() - 1);
+            if (msg.isNoteOn())
+            {
+                auto& count = sounding[ch][(size_t) msg.getNoteNumber()];
+                count = (juce::uint8) juce::jmin(255, count + 1);
+                ++numNotes;
+            }
+            else if (msg.isNoteOff())
+            {
+                auto& count = sounding[ch][(size_t) msg.getNoteNumber()];
+                if (count == 0)
+                    continue;  // su note-on quedó fuera de la ventana
+                --count;
+            }
+            seq.addEvent(msg);
+        }
+
+        const double endTicks = juce::jmax(toTicks(endQN), seq.getEndTime());
+        for (int ch = 0; ch < 16; ++ch)
+            for (int note = 0; note < 128; ++note)
+                for (int n = 0; n < sounding[(size_t) ch][(size_t) note]; ++n)
+                    seq.addEvent(juce::MidiMessage::noteOff(ch + 1, note), endTicks);
+
+        seq.updateMatchedPairs();
+
+        juce::MidiFile mf;
+        mf.setTicksPerQuarterNote(ticksPerQN);
+        mf.addTrack(seq);
+        return mf.writeTo(out) ? numNotes : 0;
+    }
+
+    CaptureExporter::CaptureExporter(const OutputCapture& source)
+        : juce::Thread("ChordCompanion capture export"),
+          capture(source)
+    {
+        startThread();
+    }
+
+    CaptureExporter::~CaptureExporter()
+    {
+        signalThreadShouldExit();
+        notify();
+        stopThread(2000);
+
+        // El último clip se deja si se arrastró: el host puede importarlo de forma diferida
+        if (! clipDragged)
+            clip.file.deleteFile();
+    }
+
+    void CaptureExporter::request(int bars)
+    {
+        {
+            const juce::ScopedLock sl(lock);
+            pendingBars = bars;
+            hasPending = true;
+        }
+        notify();
+    }
+
+    CaptureExporter::Clip CaptureExporter::getClip() const
+    {
+        const juce::ScopedLock sl(lock);
+        return clip;
+    }
+
+    void CaptureExporter::markDragged()
+    {
+        const juce::ScopedLock sl(lock);
+        clipDragged = true;
+    }
+
+    void CaptureExporter::run()
+    {
+        juce::MemoryBlock data;
+        while (! threadShouldExit())
+        {
+            int bars = 0;
+            {
+                const juce::ScopedLock sl(lock);
+                if (hasPending)
+                {
+                    bars = pendingBars;
+                    hasPending = false;
+                }
+            }
+
+            const auto count = capture.getNumCaptured();
+            if (bars <= 0 || (count == exportedCount && bars == exportedBars))
+            {
+                wait(-1);
+                continue;
+            }
+            exportedCount = count;
+            exportedBars = bars;
+
+            // Serialización en memoria; al disco solo el resultado, de una vez
+            const double endQN = capture.snapshot(bars * 4.0, events);
+            data.reset();
+            int numNotes = 0;
+            {
+                juce::MemoryOutputStream stream(data, false);
+                numNotes = writeCaptureAsMidi(events, endQN, capture.getBpm(), stream);
+            }
+            if (numNotes == 0)
+                continue;
+
+            const auto dir = juce::File::getSpecialLocation(juce::File::tempDirectory).getChildFile("ChordCompanion");
+            dir.createDirectory();
+            const auto file = dir.getChildFile("capture-" + juce::Time::getCurrentTime().formatted("%Y%m%d-%H%M%S")
+                                               + "-" + juce::String(++fileCounter) + ".mid");
+            if (! file.replaceWithData(data.getData(), data.getSize()))
+                continue;
+
+            juce::File superseded;
+            {
+                const juce::ScopedLock sl(lock);
+                if (! clipDragged)
+                    superseded = clip.file;
+                clip = { file, numNotes, bars };
+                clipDragged = false;
+            }
+            superseded.deleteFile();
+            sendChangeMessage();
+        }
+    }
+}
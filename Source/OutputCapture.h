@@ -0,0 +1,107 @@
+// OutputCapture.h
+// Captura continua de la salida MIDI: ring lock-free reservado de antemano (el hilo de audio solo escribe
+// atómicos relajados) y exportación en un hilo de fondo a un archivo MIDI para arrastrarlo al DAW.
+
+#pragma once
+
+#include <juce_audio_basics/juce_audio_basics.h>
+#include <juce_events/juce_events.h>
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <vector>
+
+namespace cc
+{
+    struct CapturedEvent
+    {
+        double qn = 0.0;  // posición en negras del reloj de captura
+        juce::uint8 data[3] {};
+        int size = 0;
+    };
+
+    // Un escritor (hilo de audio) y cualquier número de lectores. Cada evento ocupa una ranura de atómicos;
+    // 'claimed' se publica antes de escribir la ranura y 'written' después, así un lector detecta
+    // (y descarta) las ranuras que el escritor ha sobrescrito mientras las copiaba.
+    class OutputCapture
+    {
+    public:
+        static constexpr int capacity = 1 << 14;  // eventos (potencia de 2)
+
+        OutputCapture();
+
+        // Hilo de audio: eventos de canal de 'out' (sin SysEx ni tiempo real). El reloj de captura avanza
+        // con el tempo del bloque: es continuo aunque el host pare, salte o haga bucles.
+        void captureBlock(const juce::MidiBuffer& out, int numSamples, double sampleRate, double blockBpm) noexcept;
+
+        // Cualquier hilo
+        juce::uint64 getNumCaptured() const noexcept { return written.load(std::memory_order_acquire); }
+        double getBpm() const noexcept { return bpm.load(std::memory_order_relaxed); }
+
+        // Copia los eventos de las últimas 'windowQN' negras; devuelve la posición actual del reloj
+        double snapshot(double windowQN, std::vector<CapturedEvent>& out) const;
+
+    private:
+        struct Slot
+        {
+            std::atomic<double> qn { 0.0 };
+            std::atomic<juce::uint32> message { 0 };  // 3 bytes + tamaño en el byte alto
+        };
+
+        std::vector<Slot> slots;
+        std::atomic<juce::uint64> claimed { 0 };
+        std::atomic<juce::uint64> written { 0 };
+        std::atomic<double> clock { 0.0 };
+        std::atomic<double> bpm { 120.0 };
+
+        JUCE_DECLARE_NON_COPYABLE(OutputCapture)
+    };
+
+    // Serializa los eventos como archivo MIDI de una pista: empieza en el compás (4/4) del primer evento,
+    // descarta note-offs sin su note-on y cierra en 'endQN' las notas que siguen sonando.
+    // Devuelve el número de notas escritas.
+    int writeCaptureAsMidi(const std::vector<CapturedEvent>& events, double endQN, double bpm, juce::OutputStream& out);
+
+    // Hilo de fondo que mantiene el clip de arrastre: serializa en memoria y lo deja en un archivo temporal
+    // (el arrastre externo de JUCE solo admite archivos). Los resultados se anuncian con sendChangeMessage.
+    class CaptureExporter : public juce::ChangeBroadcaster,
+                            private juce::Thread
+    {
+    public:
+        struct Clip
+        {
+            juce::File file;  // vacío si aún no se ha capturado nada
+            int numNotes = 0;
+            int bars = 0;
+        };
+
+        explicit CaptureExporter(const OutputCapture& source);
+        ~CaptureExporter() override;
+
+        // Rehace el clip si hay eventos nuevos o cambió la ventana; no bloquea
+        void request(int bars);
+        Clip getClip() const;
+
+        // El clip actual se ha arrastrado: el host puede seguir leyéndolo, no se borra al sustituirlo
+        void markDragged();
+
+    private:
+        void run() override;
+
+        const OutputCapture& capture;
+
+        juce::CriticalSection lock;
+        int pendingBars = 0;
+        bool hasPending = false;
+        Clip clip;
+        bool clipDragged = false;
+
+        // Solo hilo de trabajo
+        std::vector<CapturedEvent> events;
+        juce::uint64 exportedCount = 0;
+        int exportedBars = 0;
+        int fileCounter = 0;
+
+        JUCE_DECLARE_NON_COPYABLE(CaptureExporter)
+    };
+}
@@ -0,0 +1,86 @@
+// ParameterAutomation.cpp
+
+#include "ParameterAutomation.h"
+
+namespace cc
+{
+    // Mismo orden que LiveParam
+    static const char* const liveParamIDs[numLiveParams] =
+    {
+        ParamID::key, ParamID::scale, ParamID::chordQuality,
+        ParamID::add7, ParamID::add9, ParamID::add11, ParamID::add13, ParamID::inversion,
+        ParamID::velocity, ParamID::noteLengthMs, ParamID::humanizeMs, ParamID::humanizeVel, ParamID::octave,
+        ParamID::pattern, ParamID::patternRate, ParamID::strumMs, ParamID::ratchet
+    };
+
+    // Controladores de propósito general (GP1–GP4) -> ajuste en vivo
+    struct LiveCcMapping
+    {
+        int controller;
+        LiveParam param;
+    };
+
+    static constexpr LiveCcMapping liveCcMappings[] =
+    {
+        { 16, LiveParam::velocity },
+        { 17, LiveParam::noteLengthMs },
+        { 18, LiveParam::humanizeMs },
+        { 19, LiveParam::strumMs }
+    };
+
+    ParameterAutomation::ParameterAutomation(juce::AudioProcessorValueTreeState& apvts)
+    {
+        for (int i = 0; i < numLiveParams; ++i)
+        {
+            rawValues[(size_t) i] = apvts.getRawParameterValue(liveParamIDs[i]);
+            parameters[(size_t) i] = apvts.getParameter(liveParamIDs[i]);
+            jassert(rawValues[(size_t) i] != nullptr && parameters[(size_t) i] != nullptr);
+        }
+
+        reset();
+    }
+
+    int ParameterAutomation::readPlain(int liveParam) const
+    {
+        return (int) std::lrintf(rawValues[(size_t) liveParam]->load());
+    }
+
+    void ParameterAutomation::reset()
+    {
+        fromCc.fill(false);
+        for (int i = 0; i < numLiveParams; ++i)
+            hostSettings.values[(size_t) i] = settings.values[(size_t) i] = readPlain(i);
+    }
+
+    void ParameterAutomation::beginBlock()
+    {
+        for (int i = 0; i < numLiveParams; ++i)
+        {
+            const int value = readPlain(i);
+            if (value != hostSettings.values[(size_t) i])
+                fromCc[(size_t) i] = false;  // el host (o el editor) vuelve a mandar
+            hostSettings.values[(size_t) i] = value;
+            if (! fromCc[(size_t) i])
+                settings.values[(size_t) i] = value;
+        }
+    }
+
+    bool ParameterAutomation::applyControlChange(int controller, int value) noexcept
+    {
+        for (const auto& mapping : liveCcMappings)
+        {
+            if (mapping.controller != controller)
+                continue;
+
+            const auto index = (size_t) mapping.param;
+            const float normalised = (float) juce::jlimit(0, 127, value) / 127.0f;
+            const int plain = (int) std::lrintf(parameters[index]->convertFrom0to1(normalised));
+            fromCc[index] = true;
+            if (settings.values[index] == plain)
+                return false;
+            settings.values[index] = plain;
+            return true;
+        }
+        return false;
+    }
+}
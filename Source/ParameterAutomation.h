@@ -0,0 +1,76 @@
+// ParameterAutomation.h
+// Ajustes del camino en vivo: instantánea por bloque de los parámetros que afectan a los acordes
+
+#pragma once
+
+#include <juce_audio_processors/juce_audio_processors.h>
+#include <array>
+#include "Parameters.h"
+#include "Theory.h"
+
+namespace cc
+{
+    // Parámetros que afectan a los acordes generados en vivo
+    enum class LiveParam : int
+    {
+        key = 0, scale, chordQuality, add7, add9, add11, add13, inversion,
+        velocity, noteLengthMs, humanizeMs, humanizeVel, octave,
+        pattern, patternRate, strumMs, ratchet,
+        count
+    };
+
+    static constexpr int numLiveParams = (int) LiveParam::count;
+
+    // Instantánea de los ajustes en vivo (valores "plain", enteros)
+    struct LiveSettings
+    {
+        std::array<int, numLiveParams> values {};
+
+        int  operator[](LiveParam p) const { return values[(size_t) p]; }
+        int& operator[](LiveParam p)       { return values[(size_t) p]; }
+
+        ScaleType    scale() const   { return (ScaleType) (*this)[LiveParam::scale]; }
+        ChordQuality quality() const { return (ChordQuality) (*this)[LiveParam::chordQuality]; }
+        PatternMode  pattern() const { return (PatternMode) (*this)[LiveParam::pattern]; }
+        PatternRate  patternRate() const { return (PatternRate) (*this)[LiveParam::patternRate]; }
+
+        ExtensionToggles toggles() const
+        {
+            return { (*this)[LiveParam::add7] != 0, (*this)[LiveParam::add9] != 0,
+                     (*this)[LiveParam::add11] != 0, (*this)[LiveParam::add13] != 0 };
+        }
+    };
+
+    // Instantánea de los ajustes en vivo, tomada al inicio de cada bloque.
+    // JUCE entrega solo el último valor de cada parámetro en el bloque (sin offset), así que un cambio
+    // automatizado se aplica en el sample 0 del bloque en que llega: el límite es el tamaño de bloque.
+    // Los controladores de propósito general de la entrada (CC 16–19) sí llegan con su offset: aplicados
+    // en orden junto a los note-ons, los acordes posteriores del mismo bloque ya usan el valor nuevo.
+    class ParameterAutomation
+    {
+    public:
+        explicit ParameterAutomation(juce::AudioProcessorValueTreeState& apvts);
+
+        // Inicio de bloque: lee los valores actuales del APVTS. Un valor fijado por CC se mantiene
+        // hasta que el parámetro cambia en el host o en el editor.
+        void beginBlock();
+
+        // CC de la entrada en su posición del bloque. true si cambió algún ajuste.
+        bool applyControlChange(int controller, int value) noexcept;
+
+        const LiveSettings& current() const { return settings; }
+
+        // Reinicia la instantánea desde el APVTS (descarta los valores fijados por CC)
+        void reset();
+
+    private:
+        int readPlain(int liveParam) const;
+
+        std::array<std::atomic<float>*, numLiveParams> rawValues {};
+        std::array<juce::RangedAudioParameter*, numLiveParams> parameters {};
+
+        LiveSettings settings;
+        LiveSettings hostSettings;                      // último valor leído del APVTS
+        std::array<bool, numLiveParams> fromCc {};      // ajuste fijado por CC
+    };
+}
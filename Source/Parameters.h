@@ -41,6 +41,70 @@ namespace cc // ChordCompanion
         Thirteenth
     };
 
+    // Patrón de emisión de las notas del acorde
+    enum class PatternMode : int
+    {
+        Block = 0,
+        StrumUp,
+        StrumDown,
+        ArpUp,
+        ArpDown,
+        ArpUpDown,
+        ArpOutsideIn
+    };
+
+    // Duración de cada paso del arpegio (en fracciones de negra)
+    enum class PatternRate : int
+    {
+        Quarter = 0,
+        Eighth,
+        Sixteenth,
+        ThirtySecond
+    };
+
+    // Curva de controlador por acorde (se reinicia en cada cambio de acorde)
+    enum class CcShape : int
+    {
+        Off = 0,
+        Swell,        // sube durante el acorde
+        Fade,         // baja durante el acorde
+        Arch,         // sube y baja (media onda)
+        FilterSweep,  // subida exponencial, lenta al principio
+        ModWobble     // dos ciclos de seno alrededor del centro
+    };
+
+    // Duración de cada acorde de un carril extra (en notas; T = tresillo, . = con puntillo)
+    enum class LaneRate : int
+    {
+        Whole = 0,
+        DottedHalf,
+        Half,
+        HalfTriplet,    // 3 contra 4 frente a negras
+        Quarter,
+        QuarterTriplet
+    };
+
+    enum class LaneVoicing : int
+    {
+        Chord = 0, // acorde completo
+        Root       // solo la fundamental (carril de bajo)
+    };
+
+    enum class TriggerMode : int
+    {
+        Progression = 0, // cada note-on toca el grado actual de la progresión
+        KeyboardSplit,   // bajo el punto de división cada tecla elige su acorde
+        Harmonizer       // cada nota de la melodía suena con el acorde diatónico que la contiene
+    };
+
+    // Papel en el bus de armonía compartido entre instancias del mismo proceso
+    enum class HarmonyRole : int
+    {
+        Off = 0,
+        Leader,   // publica su tonalidad, escala y grado en cada bloque
+        Follower  // toma tonalidad, escala y grado del líder; la voz (calidad, extensiones, octava) es propia
+    };
+
     // IDs de parámetros (estables)
     namespace ParamID
     {
@@ -60,13 +124,49 @@ namespace cc // ChordCompanion
         static constexpr const char* humanizeVel = "humanizeVel";
         static constexpr const char* octave = "octave";
         static constexpr const char* followHost = "followHost";
-        static constexpr const char* generateNow = "generateNow"; // botón/flag one-shot
-        static constexpr const char* exportMidi = "exportMidi";   // botón para FileChooser
+        static constexpr const char* clockSync = "clockSync";         // reloj MIDI externo si no hay transporte
+        static constexpr const char* pattern = "pattern";
+        static constexpr const char* patternRate = "patternRate";
+        static constexpr const char* strumMs = "strumMs";
+        static constexpr const char* ratchet = "ratchet";
+        static constexpr const char* seed = "seed"; // 0 = aleatorio; >0 = humanización reproducible
+        static constexpr const char* lookAhead = "lookAhead";         // retrasa la salida y reporta latencia
+        static constexpr const char* lookAheadMs = "lookAheadMs";
+        static constexpr const char* quantizeInput = "quantizeInput"; // Off o rejilla (índice PatternRate + 1)
+        static constexpr const char* triggerMode = "triggerMode";
+        static constexpr const char* splitPoint = "splitPoint";       // primera nota que pasa sin acorde
+        static constexpr const char* stormMode = "stormMode";         // agrupa ráfagas de note-ons
+        static constexpr const char* coalesceMs = "coalesceMs";       // ventana de agrupación
+        static constexpr const char* eventBudget = "eventBudget";     // eventos programados máx. por bloque
+        static constexpr const char* legato = "legato";               // liga notas comunes entre acordes
+        static constexpr const char* ccShape = "ccShape";             // curva de CC por acorde
+        static constexpr const char* ccNumber = "ccNumber";           // controlador de destino
+        static constexpr const char* ccThreshold = "ccThreshold";     // cambio mínimo para enviar un CC
+        static constexpr const char* previewSynth = "previewSynth";   // toca la salida en el bus de audio
+        static constexpr const char* previewLevel = "previewLevel";
+        static constexpr const char* captureBars = "captureBars";     // compases de salida en el clip de arrastre
+        static constexpr const char* harmonyRole = "harmonyRole";     // bus de armonía entre instancias
+        static constexpr const char* multitimbral = "multitimbral";   // una progresión por canal de entrada
+        static constexpr const char* wireModel = "wireModel";         // ordena y reparte la salida al ritmo de un cable DIN
+        static constexpr const char* liveCcControl = "liveCcControl"; // CC 16–19 de la entrada ajustan el camino en vivo
         // Propiedades auxiliares (no parámetros): strings para mostrar notas
-        static constexpr const char* lastChordNotes = "lastChordNotes"; // e.g. "C4 E4 G4"
         static constexpr const char* sequenceNotes  = "sequenceNotes";  // resumen de cola
     }
 
+    // Carriles extra (el carril 0 es la progresión principal): cada uno con su progresión, duración y canal
+    static constexpr int numExtraLanes = 3;
+
+    namespace LaneParamID
+    {
+        static constexpr const char* enabled[numExtraLanes]     = { "lane1Enabled", "lane2Enabled", "lane3Enabled" };
+        static constexpr const char* progression[numExtraLanes] = { "lane1Progression", "lane2Progression", "lane3Progression" };
+        static constexpr const char* rate[numExtraLanes]        = { "lane1Rate", "lane2Rate", "lane3Rate" };
+        static constexpr const char* gate[numExtraLanes]        = { "lane1Gate", "lane2Gate", "lane3Gate" };           // % de la duración
+        static constexpr const char* channel[numExtraLanes]     = { "lane1Channel", "lane2Channel", "lane3Channel" };
+        static constexpr const char* octave[numExtraLanes]      = { "lane1Octave", "lane2Octave", "lane3Octave" };     // desplazamiento
+        static constexpr const char* voicing[numExtraLanes]     = { "lane1Voicing", "lane2Voicing", "lane3Voicing" };
+    }
+
     inline juce::StringArray getKeyChoices()
     {
         return { "C", "C#", "D", "D#", "E", "F", "F#", "G", "G#", "A", "A#", "B" };
@@ -88,6 +188,66 @@ namespace cc // ChordCompanion
         return { "Triad", "Seventh", "Ninth", "Eleventh", "Thirteenth" };
     }
 
+    inline juce::StringArray getPatternChoices()
+    {
+        return { "Block", "Strum Up", "Strum Down", "Arp Up", "Arp Down", "Arp Up-Down", "Arp Outside-In" };
+    }
+
+    inline juce::StringArray getPatternRateChoices()
+    {
+        return { "1/4", "1/8", "1/16", "1/32" };
+    }
+
+    inline juce::StringArray getTriggerModeChoices()
+    {
+        return { "Progression", "Keyboard Split", "Harmonizer" };
+    }
+
+    inline juce::StringArray getCcShapeChoices()
+    {
+        return { "CC Off", "Swell", "Fade", "Arch", "Filter Sweep", "Mod Wobble" };
+    }
+
+    inline juce::StringArray getHarmonyRoleChoices()
+    {
+        return { "Bus Off", "Bus Leader", "Bus Follower" };
+    }
+
+    inline juce::StringArray getLaneProgressionChoices()
+    {
+        // 0 = la progresión del carril principal; el resto, los presets (sin Custom)
+        return { "Main", "I-V-vi-IV", "ii-V-I", "I-vi-IV-V", "vi-IV-I-V" };
+    }
+
+    inline juce::StringArray getLaneRateChoices()
+    {
+        return { "1/1", "1/2.", "1/2", "1/2T", "1/4", "1/4T" };
+    }
+
+    inline double laneRateToQuarterNotes(LaneRate rate)
+    {
+        switch (rate)
+        {
+            case LaneRate::Whole:          return 4.0;
+            case LaneRate::DottedHalf:     return 3.0;
+            case LaneRate::Half:           return 2.0;
+            case LaneRate::HalfTriplet:    return 4.0 / 3.0;
+            case LaneRate::Quarter:        return 1.0;
+            case LaneRate::QuarterTriplet: return 2.0 / 3.0;
+        }
+        return 4.0;
+    }
+
+    inline juce::StringArray getLaneVoicingChoices()
+    {
+        return { "Chord", "Root" };
+    }
+
+    inline juce::StringArray getQuantizeChoices()
+    {
+        return { "Quantize Off", "1/4", "1/8", "1/16", "1/32" };
+    }
+
     // Construye el layout de parámetros para APVTS
     inline juce::AudioProcessorValueTreeState::ParameterLayout createParameterLayout()
     {
@@ -99,6 +259,12 @@ namespace cc // ChordCompanion
         params.push_back(std::make_unique<AudioParameterChoice>(ParamID::scale, "Scale", getScaleChoices(), (int) ScaleType::Major));
         params.push_back(std::make_unique<AudioParameterChoice>(ParamID::progressionPreset, "Progression Preset", getProgressionChoices(), (int) ProgressionPreset::I_V_vi_IV));
         params.push_back(std::make_unique<AudioParameterChoice>(ParamID::chordQuality, "Chord Quality", getChordQualityChoices(), (int) ChordQuality::Triad));
+        params.push_back(std::make_unique<AudioParameterChoice>(ParamID::pattern, "Pattern", getPatternChoices(), (int) PatternMode::Block));
+        params.push_back(std::make_unique<AudioParameterChoice>(ParamID::patternRate, "Pattern Rate", getPatternRateChoices(), (int) PatternRate::Sixteenth));
+        params.push_back(std::make_unique<AudioParameterChoice>(ParamID::triggerMode, "Trigger Mode", getTriggerModeChoices(), (int) TriggerMode::Progression));
+        params.push_back(std::make_unique<AudioParameterChoice>(ParamID::quantizeInput, "Quantize Input", getQuantizeChoices(), 0));
+        params.push_back(std::make_unique<AudioParameterChoice>(ParamID::ccShape, "CC Shape", getCcShapeChoices(), (int) CcShape::Off));
+        params.push_back(std::make_unique<AudioParameterChoice>(ParamID::harmonyRole, "Harmony Bus", getHarmonyRoleChoices(), (int) HarmonyRole::Off));
 
         // Nota: JUCE no ofrece AudioParameterString estándar.
         // Usaremos una propiedad en el ValueTree (apvts.state) para progressionCustom.
@@ -110,10 +276,16 @@ namespace cc // ChordCompanion
         params.push_back(std::make_unique<AudioParameterBool>(ParamID::add11, "Add 11", false));
         params.push_back(std::make_unique<AudioParameterBool>(ParamID::add13, "Add 13", false));
         params.push_back(std::make_unique<AudioParameterBool>(ParamID::followHost, "Follow Host", true));
+        params.push_back(std::make_unique<AudioParameterBool>(ParamID::clockSync, "MIDI Clock Sync", false));
+        params.push_back(std::make_unique<AudioParameterBool>(ParamID::lookAhead, "Look-Ahead", false));
+        params.push_back(std::make_unique<AudioParameterBool>(ParamID::stormMode, "Storm Mode", false));
+        params.push_back(std::make_unique<AudioParameterBool>(ParamID::legato, "Legato Ties", false));
+        params.push_back(std::make_unique<AudioParameterBool>(ParamID::previewSynth, "Preview Synth", false));
+        params.push_back(std::make_unique<AudioParameterBool>(ParamID::multitimbral, "Multitimbral", false));
+        params.push_back(std::make_unique<AudioParameterBool>(ParamID::wireModel, "DIN Wire Model", false));
+        params.push_back(std::make_unique<AudioParameterBool>(ParamID::liveCcControl, "Live CC Control", false));
 
-        // Botones/flags one-shot
-        params.push_back(std::make_unique<AudioParameterBool>(ParamID::generateNow, "Generate Now", false));
-        params.push_back(std::make_unique<AudioParameterBool>(ParamID::exportMidi, "Export MIDI", false));
+        // Generate/Stop no son parámetros (no automatizables): el editor los envía por la cola de órdenes
 
         // Int ranges
         params.push_back(std::make_unique<AudioParameterInt>(ParamID::inversion, "Inversion", 0, 3, 0));
@@ -122,6 +294,38 @@ namespace cc // ChordCompanion
         params.push_back(std::make_unique<AudioParameterInt>(ParamID::humanizeMs, "Humanize (ms)", 0, 25, 0));
         params.push_back(std::make_unique<AudioParameterInt>(ParamID::humanizeVel, "Humanize Velocity", 0, 15, 0));
         params.push_back(std::make_unique<AudioParameterInt>(ParamID::octave, "Octave", 3, 6, 4));
+        params.push_back(std::make_unique<AudioParameterInt>(ParamID::strumMs, "Strum (ms)", 0, 100, 25));
+        params.push_back(std::make_unique<AudioParameterInt>(ParamID::ratchet, "Ratchet", 1, 4, 1));
+        params.push_back(std::make_unique<AudioParameterInt>(ParamID::seed, "Deterministic Seed", 0, 65535, 0));
+        params.push_back(std::make_unique<AudioParameterInt>(ParamID::lookAheadMs, "Look-Ahead (ms)", 5, 250, 30));
+        params.push_back(std::make_unique<AudioParameterInt>(ParamID::splitPoint, "Split Point", 0, 127, 60));
+        params.push_back(std::make_unique<AudioParameterInt>(ParamID::coalesceMs, "Coalesce (ms)", 1, 100, 20));
+        params.push_back(std::make_unique<AudioParameterInt>(ParamID::eventBudget, "Event Budget", 16, 1024, 256));
+        params.push_back(std::make_unique<AudioParameterInt>(ParamID::ccNumber, "CC Number", 1, 119, 11));
+        params.push_back(std::make_unique<AudioParameterInt>(ParamID::ccThreshold, "CC Threshold", 1, 16, 2));
+        params.push_back(std::make_unique<AudioParameterInt>(ParamID::previewLevel, "Preview Level (%)", 0, 100, 70));
+        params.push_back(std::make_unique<AudioParameterInt>(ParamID::captureBars, "Capture (bars)", 1, 64, 8));
+
+        // Carriles extra: por defecto bajo en redondas, pad en blancas y stabs en tresillos de blanca (apagados)
+        struct LaneDefaults { LaneRate rate; int gate, channel, octave; LaneVoicing voicing; };
+        static constexpr LaneDefaults laneDefaults[numExtraLanes] =
+        {
+            { LaneRate::Whole,       95, 3, -1, LaneVoicing::Root },
+            { LaneRate::Half,       100, 4,  0, LaneVoicing::Chord },
+            { LaneRate::HalfTriplet, 25, 5,  1, LaneVoicing::Chord },
+        };
+        for (int lane = 0; lane < numExtraLanes; ++lane)
+        {
+            const auto& d = laneDefaults[lane];
+            const String name = "Lane " + String(lane + 1) + " ";
+            params.push_back(std::make_unique<AudioParameterBool>(LaneParamID::enabled[lane], name + "Enabled", false));
+            params.push_back(std::make_unique<AudioParameterChoice>(LaneParamID::progression[lane], name + "Progression", getLaneProgressionChoices(), 0));
+            params.push_back(std::make_unique<AudioParameterChoice>(LaneParamID::rate[lane], name + "Rate", getLaneRateChoices(), (int) d.rate));
+            params.push_back(std::make_unique<AudioParameterInt>(LaneParamID::gate[lane], name + "Gate (%)", 5, 100, d.gate));
+            params.push_back(std::make_unique<AudioParameterInt>(LaneParamID::channel[lane], name + "Channel", 1, 16, d.channel));
+            params.push_back(std::make_unique<AudioParameterInt>(LaneParamID::octave[lane], name + "Octave", -2, 2, d.octave));
+            params.push_back(std::make_unique<AudioParameterChoice>(LaneParamID::voicing[lane], name + "Voicing", getLaneVoicingChoices(), (int) d.voicing));
+        }
 
         return { params.begin(), params.end() };
     }
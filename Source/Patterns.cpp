@@ -0,0 +1,137 @@
+// Patterns.cpp
+
+#include "Patterns.h"
+
+namespace cc
+{
+    static constexpr int numPatternModes = (int) PatternMode::ArpOutsideIn + 1;
+
+    namespace
+    {
+        struct PatternTables
+        {
+            PatternTables()
+            {
+                for (int m = 0; m < numPatternModes; ++m)
+                    for (int n = 0; n <= ChordNotes::maxNotes; ++n)
+                        build((PatternMode) m, n, tables[(size_t) m][(size_t) n]);
+            }
+
+            static void build(PatternMode mode, int n, PatternTable& t)
+            {
+                auto push = [&t](int voice) { t.order[(size_t) t.length++] = (juce::uint8) voice; };
+
+                switch (mode)
+                {
+                    case PatternMode::StrumDown:
+                    case PatternMode::ArpDown:
+                        for (int i = n - 1; i >= 0; --i) push(i);
+                        break;
+
+                    case PatternMode::ArpUpDown:
+                        for (int i = 0; i < n; ++i) push(i);
+                        for (int i = n - 2; i >= 1; --i) push(i);
+                        break;
+
+                    case PatternMode::ArpOutsideIn:
+                        for (int lo = 0, hi = n - 1; lo <= hi; ++lo, --hi)
+                        {
+                            push(lo);
+                            if (hi != lo) push(hi);
+                        }
+                        break;
+
+                    case PatternMode::Block:
+                    case PatternMode::StrumUp:
+                    case PatternMode::ArpUp:
+                    default:
+                        for (int i = 0; i < n; ++i) push(i);
+                        break;
+                }
+            }
+
+            std::array<std::array<PatternTable, ChordNotes::maxNotes + 1>, numPatternModes> tables;
+        };
+    }
+
+    const PatternTable& getPatternTable(PatternMode mode, int numVoices)
+    {
+        static const PatternTables instance;
+        const int m = juce::jlimit(0, numPatternModes - 1, (int) mode);
+        const int n = juce::jlimit(0, ChordNotes::maxNotes, numVoices);
+        return instance.tables[(size_t) m][(size_t) n];
+    }
+
+    int expandPattern(PatternMode mode,
+                      const ChordNotes& chord,
+                      const PatternTiming& timing,
+                      PatternNotes& out)
+    {
+        const auto& table = getPatternTable(mode, chord.size);
+        if (table.length == 0)
+            return 0;
+
+        const juce::int64 end = timing.start + juce::jmax((juce::int64) 1, timing.length);
+        int count = 0;
+
+        switch (mode)
+        {
+            case PatternMode::Block:
+            case PatternMode::StrumUp:
+            case PatternMode::StrumDown:
+            {
+                // Todas las voces se sostienen hasta el final del acorde; el strum solo desplaza el ataque
+                const juce::int64 spacing = (mode == PatternMode::Block) ? 0 : timing.strum;
+                for (int i = 0; i < table.length; ++i)
+                {
+                    auto& pn = out[(size_t) count++];
+                    pn.note = chord.notes[table.order[(size_t) i]];
+                    pn.on   = juce::jmin(end - 1, timing.start + spacing * i);
+                    pn.off  = end;
+                }
+                break;
+            }
+
+            default:
+            {
+                // Arpegio: recorre la tabla cíclicamente hasta el final del acorde,
+                // cada paso subdividido en 'ratchet' repeticiones
+                const juce::int64 step = juce::jmax((juce::int64) 1, timing.step);
+                const int ratchet = juce::jlimit(1, 8, timing.ratchet);
+                const juce::int64 sub = juce::jmax((juce::int64) 1, step / ratchet);
+
+                juce::int64 stepStart = timing.start;
+                for (int s = 0; stepStart < end && count < maxPatternNotes; ++s, stepStart += step)
+                {
+                    const int note = chord.notes[table.order[(size_t) (s % table.length)]];
+                    for (int r = 0; r < ratchet && count < maxPatternNotes; ++r)
+                    {
+                        const juce::int64 on = stepStart + sub * r;
+                        if (on >= end)
+                            break;
+
+                        auto& pn = out[(size_t) count++];
+                        pn.note = note;
+                        pn.on   = on;
+                        pn.off  = juce::jmin(end, on + sub);
+                    }
+                }
+                break;
+            }
+        }
+
+        return count;
+    }
+
+    double patternRateToQuarterNotes(PatternRate rate)
+    {
+        switch (rate)
+        {
+            case PatternRate::Quarter:      return 1.0;
+            case PatternRate::Eighth:       return 0.5;
+            case PatternRate::Sixteenth:    return 0.25;
+            case PatternRate::ThirtySecond: return 0.125;
+            default:                        return 0.25;
+        }
+    }
+}
@@ -0,0 +1,56 @@
+// Patterns.h
+// Motor de patrones (strum, arpegio, ratchet): tablas de pasos precalculadas y expansión sin asignaciones
+
+#pragma once
+
+#include <juce_core/juce_core.h>
+#include <array>
+#include "Parameters.h"
+#include "Theory.h"
+
+namespace cc
+{
+    // Tabla de pasos precalculada para un modo y un número de voces:
+    // order[i] = índice de la voz (nota del acorde, de grave a agudo) del paso i
+    struct PatternTable
+    {
+        static constexpr int maxSteps = 2 * ChordNotes::maxNotes;
+
+        std::array<juce::uint8, maxSteps> order {};
+        int length = 0;
+    };
+
+    // Devuelve la tabla precalculada para mode/numVoices (se construyen todas una sola vez)
+    const PatternTable& getPatternTable(PatternMode mode, int numVoices);
+
+    // Tiempos de la expansión en unidades absolutas (samples o ticks):
+    // el resultado no depende del tamaño de bloque
+    struct PatternTiming
+    {
+        juce::int64 start = 0;   // inicio del acorde
+        juce::int64 length = 0;  // duración del acorde
+        juce::int64 step = 0;    // duración de un paso de arpegio
+        juce::int64 strum = 0;   // separación entre voces en strum
+        int ratchet = 1;         // repeticiones por paso
+    };
+
+    struct PatternNote
+    {
+        juce::int64 on = 0;
+        juce::int64 off = 0;
+        int note = 0;
+    };
+
+    // Máximo de notas por acorde expandido: acota el coste de cada cambio de acorde
+    static constexpr int maxPatternNotes = 256;
+    using PatternNotes = std::array<PatternNote, maxPatternNotes>;
+
+    // Expande el acorde según el patrón. Devuelve el número de notas escritas en 'out'.
+    int expandPattern(PatternMode mode,
+                      const ChordNotes& chord,
+                      const PatternTiming& timing,
+                      PatternNotes& out);
+
+    // Duración de un paso en negras
+    double patternRateToQuarterNotes(PatternRate rate);
+}
@@ -0,0 +1,163 @@
+// PerfTrace.cpp
+
+#include "PerfTrace.h"
+
+namespace cc
+{
+    // Hilo escritor: vacía el ring periódicamente en un historial acotado y escribe el JSON bajo demanda
+    class PerfTrace::Writer : public juce::Thread
+    {
+    public:
+        explicit Writer(PerfTrace& o)
+            : juce::Thread("ChordCompanion trace writer"), owner(o)
+        {
+            history.reserve(maxHistory);
+        }
+
+        ~Writer() override { stopThread(2000); }
+
+        void requestDump(const juce::File& dest)
+        {
+            {
+                const juce::ScopedLock sl(dumpLock);
+                pendingDump = dest;
+            }
+            notify();
+        }
+
+        void run() override
+        {
+            while (! threadShouldExit())
+            {
+                wait(50);
+                drain();
+
+                juce::File dest;
+                {
+                    const juce::ScopedLock sl(dumpLock);
+                    std::swap(dest, pendingDump);
+                }
+                if (dest != juce::File())
+                    writeChromeTrace(dest);
+            }
+        }
+
+    private:
+        static constexpr size_t maxHistory = 1 << 20;
+
+        void drain()
+        {
+            auto& fifo = owner.fifo;
+            int start1, size1, start2, size2;
+            fifo.prepareToRead(fifo.getNumReady(), start1, size1, start2, size2);
+            for (int i = 0; i < size1; ++i) append(owner.ring[(size_t) (start1 + i)]);
+            for (int i = 0; i < size2; ++i) append(owner.ring[(size_t) (start2 + i)]);
+            fifo.finishedRead(size1 + size2);
+        }
+
+        void append(const Event& e)
+        {
+            if (history.size() < maxHistory)
+            {
+                history.push_back(e);
+                return;
+            }
+            // Historial lleno: se sobrescribe lo más antiguo
+            history[historyStart] = e;
+            historyStart = (historyStart + 1) % maxHistory;
+        }
+
+        void writeChromeTrace(const juce::File& dest)
+        {
+            juce::FileOutputStream out(dest);
+            if (! out.openedOk())
+                return;
+            out.setPosition(0);
+            out.truncate();
+
+            auto toMicros = [this](juce::int64 ticks)
+            {
+                return juce::Time::highResolutionTicksToSeconds(ticks - origin) * 1.0e6;
+            };
+
+            out << "{\"traceEvents\":[\n";
+            for (size_t i = 0; i < history.size(); ++i)
+            {
+                const auto& e = history[(historyStart + i) % history.size()];
+                out << (i == 0 ? "" : ",\n")
+                    << "{\"name\":\"" << e.name << "\",\"ph\":\"X\",\"pid\":1,\"tid\":1"
+                    << ",\"ts\":" << juce::String(toMicros(e.start), 3)
+                    << ",\"dur\":" << juce::String(toMicros(e.end) - toMicros(e.start), 3) << "}";
+            }
+            out << "\n],\"displayTimeUnit\":\"ms\"}\n";
+            out.flush();
+        }
+
+        PerfTrace& owner;
+        std::vector<Event> history;
+        size_t historyStart = 0;
+        const juce::int64 origin = juce::Time::getHighResolutionTicks();
+
+        juce::CriticalSection dumpLock;
+        juce::File pendingDump;
+    };
+
+    PerfTrace::PerfTrace() = default;
+
+    PerfTrace::~PerfTrace()
+    {
+        enabled = false;
+        writer.reset();
+    }
+
+    void PerfTrace::setEnabled(bool shouldBeEnabled)
+    {
+        if (shouldBeEnabled && writer == nullptr)
+        {
+            writer = std::make_unique<Writer>(*this);
+            writer->startThread();
+        }
+        enabled = shouldBeEnabled;
+    }
+
+    void PerfTrace::record(const char* name, juce::int64 startTicks, juce::int64 endTicks) noexcept
+    {
+        int start1, size1, start2, size2;
+        fifo.prepareToWrite(1, start1, size1, start2, size2);
+        if (size1 + size2 < 1)
+        {
+            dropped.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        ring[(size_t) (size1 > 0 ? start1 : start2)] = Event { name, startTicks, endTicks };
+        fifo.finishedWrite(1);
+    }
+
+    void PerfTrace::recordBlock(juce::int64 startTicks, juce::int64 endTicks, int numSamples, double sampleRate) noexcept
+    {
+        const auto micros = (float) (juce::Time::highResolutionTicksToSeconds(endTicks - startTicks) * 1.0e6);
+        const float avg = averageMicros.load(std::memory_order_relaxed);
+        averageMicros.store(avg + 0.05f * (micros - avg), std::memory_order_relaxed);
+        if (micros > maxMicros.load(std::memory_order_relaxed))
+            maxMicros.store(micros, std::memory_order_relaxed);
+        if (sampleRate > 0.0)
+            budgetMicros.store((float) (numSamples * 1.0e6 / sampleRate), std::memory_order_relaxed);
+    }
+
+    void PerfTrace::requestDump(const juce::File& dest)
+    {
+        if (writer != nullptr)
+            writer->requestDump(dest);
+    }
+
+    PerfTrace::Load PerfTrace::getLoad() noexcept
+    {
+        Load l;
+        l.averageMicros = averageMicros.load(std::memory_order_relaxed);
+        l.maxMicros     = maxMicros.exchange(0.0f, std::memory_order_relaxed);
+        l.budgetMicros  = budgetMicros.load(std::memory_order_relaxed);
+        l.droppedEvents = dropped.load(std::memory_order_relaxed);
+        l.droppedMidiEvents = droppedMidi.load(std::memory_order_relaxed);
+        return l;
+    }
+}
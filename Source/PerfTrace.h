@@ -0,0 +1,114 @@
+// PerfTrace.h
+// Instrumentación del hilo de audio: ring lock-free de scopes con volcado a Chrome trace JSON
+// y medidor de carga por bloque (µs medios/máximos frente al presupuesto de tiempo real)
+
+#pragma once
+
+#include <juce_core/juce_core.h>
+#include <array>
+#include <atomic>
+
+namespace cc
+{
+    class PerfTrace
+    {
+    public:
+        PerfTrace();
+        ~PerfTrace();
+
+        // Hilo de mensajes: activa/desactiva el trazado (arranca o para el hilo escritor)
+        void setEnabled(bool shouldBeEnabled);
+        bool isEnabled() const noexcept { return enabled.load(std::memory_order_relaxed); }
+
+        // Hilo de audio: registra un scope con nombre (literal de cadena). Sin bloqueos ni asignaciones.
+        void record(const char* name, juce::int64 startTicks, juce::int64 endTicks) noexcept;
+
+        // Hilo de audio: duración de un bloque completo para el medidor de carga (siempre activo)
+        void recordBlock(juce::int64 startTicks, juce::int64 endTicks, int numSamples, double sampleRate) noexcept;
+
+        // Hilo de audio: eventos MIDI descartados por colas llenas (programador, retardo, mezcla)
+        void addDroppedMidi(int numEvents) noexcept
+        {
+            if (numEvents > 0)
+                droppedMidi.fetch_add(numEvents, std::memory_order_relaxed);
+        }
+
+        // Cualquier hilo salvo el de audio: el hilo escritor vuelca el historial a 'dest' en formato Chrome trace
+        void requestDump(const juce::File& dest);
+
+        struct Load
+        {
+            float averageMicros = 0.0f;
+            float maxMicros = 0.0f;     // desde la última lectura
+            float budgetMicros = 0.0f;  // duración en tiempo real del último bloque
+            int droppedEvents = 0;      // scopes de trazado perdidos (ring lleno)
+            int droppedMidiEvents = 0;  // total desde la creación
+        };
+
+        // Lee el medidor y reinicia el máximo
+        Load getLoad() noexcept;
+
+    private:
+        struct Event
+        {
+            const char* name = nullptr;
+            juce::int64 start = 0;
+            juce::int64 end = 0;
+        };
+
+        class Writer;
+
+        static constexpr int ringSize = 1 << 15;
+
+        std::atomic<bool> enabled { false };
+        juce::AbstractFifo fifo { ringSize };
+        std::array<Event, ringSize> ring {};
+        std::atomic<int> dropped { 0 };
+        std::atomic<int> droppedMidi { 0 };
+
+        std::atomic<float> averageMicros { 0.0f }, maxMicros { 0.0f }, budgetMicros { 0.0f };
+
+        std::unique_ptr<Writer> writer;
+
+        JUCE_DECLARE_NON_COPYABLE(PerfTrace)
+    };
+
+    // Scope RAII: con el trazado desactivado solo cuesta una lectura atómica relajada
+    class ScopedTrace
+    {
+    public:
+        ScopedTrace(PerfTrace& t, const char* scopeName) noexcept
+            : trace(t), name(scopeName), start(t.isEnabled() ? juce::Time::getHighResolutionTicks() : 0) {}
+
+        ~ScopedTrace()
+        {
+            if (start != 0)
+                trace.record(name, start, juce::Time::getHighResolutionTicks());
+        }
+
+    private:
+        PerfTrace& trace;
+        const char* name;
+        juce::int64 start;
+
+        JUCE_DECLARE_NON_COPYABLE(ScopedTrace)
+    };
+
+    // Mide el bloque completo para el medidor de carga (incluye salidas tempranas)
+    class ScopedBlockLoad
+    {
+    public:
+        ScopedBlockLoad(PerfTrace& t, int samples, double rate) noexcept
+            : trace(t), numSamples(samples), sampleRate(rate), start(juce::Time::getHighResolutionTicks()) {}
+
+        ~ScopedBlockLoad() { trace.recordBlock(start, juce::Time::getHighResolutionTicks(), numSamples, sampleRate); }
+
+    private:
+        PerfTrace& trace;
+        int numSamples;
+        double sampleRate;
+        juce::int64 start;
+
+        JUCE_DECLARE_NON_COPYABLE(ScopedBlockLoad)
+    };
+}
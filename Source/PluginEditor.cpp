@@ -3,15 +3,21 @@
 #include "PluginEditor.h"
 
 ChordCompanionAudioProcessorEditor::ChordCompanionAudioProcessorEditor(ChordCompanionAudioProcessor& p)
-    : juce::AudioProcessorEditor(&p), processor(p)
+    : juce::AudioProcessorEditor(&p), processor(p), captureExporter(p.getOutputCapture())
 {
-    setSize(660, 420);
+    setSize(660, 734);
 
     // Combos
     keyBox.addItemList(cc::getKeyChoices(), 1);
     scaleBox.addItemList(cc::getScaleChoices(), 1);
     progPresetBox.addItemList(cc::getProgressionChoices(), 1);
     qualityBox.addItemList(cc::getChordQualityChoices(), 1);
+    patternBox.addItemList(cc::getPatternChoices(), 1);
+    patternRateBox.addItemList(cc::getPatternRateChoices(), 1);
+    quantizeBox.addItemList(cc::getQuantizeChoices(), 1);
+    triggerModeBox.addItemList(cc::getTriggerModeChoices(), 1);
+    ccShapeBox.addItemList(cc::getCcShapeChoices(), 1);
+    harmonyRoleBox.addItemList(cc::getHarmonyRoleChoices(), 1);
 
     inversionBox.addItemList({ "Root", "1st", "2nd", "3rd" }, 1);
 
@@ -20,6 +26,12 @@ ChordCompanionAudioProcessorEditor::ChordCompanionAudioProcessorEditor(ChordComp
     addAndMakeVisible(progPresetBox);
     addAndMakeVisible(qualityBox);
     addAndMakeVisible(inversionBox);
+    addAndMakeVisible(patternBox);
+    addAndMakeVisible(patternRateBox);
+    addAndMakeVisible(quantizeBox);
+    addAndMakeVisible(triggerModeBox);
+    addAndMakeVisible(ccShapeBox);
+    addAndMakeVisible(harmonyRoleBox);
 
     // TextEditor
     progressionCustom.setText(processor.apvts.state.getProperty(cc::ParamID::progressionCustom, juce::String("1-5-6-4")).toString());
@@ -32,11 +44,34 @@ ChordCompanionAudioProcessorEditor::ChordCompanionAudioProcessorEditor(ChordComp
     setupSlider(humanizeMsSlider);
     setupSlider(humanizeVelSlider);
     setupSlider(octaveSlider);
+    setupSlider(strumSlider);
+    setupSlider(ratchetSlider);
+    setupSlider(seedSlider);
+    setupSlider(lookAheadSlider);
+    setupSlider(coalesceSlider);
+    setupSlider(budgetSlider);
+    setupSlider(splitSlider);
+    setupSlider(ccNumberSlider);
+    setupSlider(ccThresholdSlider);
+    setupSlider(previewLevelSlider);
+    setupSlider(captureBarsSlider);
     addAndMakeVisible(velocitySlider);
     addAndMakeVisible(noteLenSlider);
     addAndMakeVisible(humanizeMsSlider);
     addAndMakeVisible(humanizeVelSlider);
     addAndMakeVisible(octaveSlider);
+    addAndMakeVisible(strumSlider);
+    addAndMakeVisible(ratchetSlider);
+    addAndMakeVisible(seedSlider);
+    addAndMakeVisible(lookAheadSlider);
+    addAndMakeVisible(coalesceSlider);
+    addAndMakeVisible(budgetSlider);
+    addAndMakeVisible(splitSlider);
+    addAndMakeVisible(ccNumberSlider);
+    addAndMakeVisible(ccThresholdSlider);
+    addAndMakeVisible(previewLevelSlider);
+    addAndMakeVisible(captureBarsSlider);
+    addAndMakeVisible(clipDragSource);
 
     // Toggles
     addAndMakeVisible(add7Toggle);
@@ -44,8 +79,46 @@ ChordCompanionAudioProcessorEditor::ChordCompanionAudioProcessorEditor(ChordComp
     addAndMakeVisible(add11Toggle);
     addAndMakeVisible(add13Toggle);
     addAndMakeVisible(followHostToggle);
-    addAndMakeVisible(generateToggle);
-    addAndMakeVisible(exportToggle);
+    addAndMakeVisible(clockSyncToggle);
+    addAndMakeVisible(lookAheadToggle);
+    addAndMakeVisible(stormToggle);
+    addAndMakeVisible(legatoToggle);
+    addAndMakeVisible(previewToggle);
+    addAndMakeVisible(multitimbralToggle);
+    addAndMakeVisible(wireToggle);
+    addAndMakeVisible(liveCcToggle);
+    liveCcToggle.setTooltip("CC 16-19 on the input set velocity, note length, humanize and strum from their sample position");
+    addAndMakeVisible(traceToggle);
+    addAndMakeVisible(dumpTraceButton);
+    addAndMakeVisible(recordToggle);
+    addAndMakeVisible(generateButton);
+    addAndMakeVisible(stopButton);
+    addAndMakeVisible(auditionButton);
+    addAndMakeVisible(reseedButton);
+    addAndMakeVisible(exportButton);
+
+    // Carriles extra
+    for (int lane = 0; lane < cc::numExtraLanes; ++lane)
+    {
+        auto& r = laneRows[(size_t) lane];
+        r.enabled.setButtonText("Lane " + juce::String(lane + 1));
+        r.progression.addItemList(cc::getLaneProgressionChoices(), 1);
+        r.rate.addItemList(cc::getLaneRateChoices(), 1);
+        r.voicing.addItemList(cc::getLaneVoicingChoices(), 1);
+        for (auto* s : { &r.gate, &r.channel, &r.octave })
+        {
+            s->setSliderStyle(juce::Slider::LinearHorizontal);
+            s->setTextBoxStyle(juce::Slider::TextBoxRight, false, 40, 20);
+            addAndMakeVisible(*s);
+        }
+        r.gate.setTooltip("Gate (%)");
+        r.channel.setTooltip("MIDI channel");
+        r.octave.setTooltip("Octave shift");
+        addAndMakeVisible(r.enabled);
+        addAndMakeVisible(r.progression);
+        addAndMakeVisible(r.rate);
+        addAndMakeVisible(r.voicing);
+    }
 
     // Label de progresión
     progressionLabel.setText("Progression: I-V-vi-IV", juce::dontSendNotification);
@@ -54,6 +127,14 @@ ChordCompanionAudioProcessorEditor::ChordCompanionAudioProcessorEditor(ChordComp
     addAndMakeVisible(lastNotesLabel);
     sequenceLabel.setText("Sequence: ", juce::dontSendNotification);
     addAndMakeVisible(sequenceLabel);
+    addAndMakeVisible(loadLabel);
+
+    for (int i = 0; i < (int) suggestionButtons.size(); ++i)
+    {
+        auto& b = suggestionButtons[(size_t) i];
+        b.onClick = [this, i] { appendSuggestion(i); };
+        addAndMakeVisible(b);
+    }
 
     // Attachments
     auto& apvts = processor.apvts;
@@ -61,21 +142,56 @@ ChordCompanionAudioProcessorEditor::ChordCompanionAudioProcessorEditor(ChordComp
     scaleAtt.reset(new juce::AudioProcessorValueTreeState::ComboBoxAttachment(apvts, cc::ParamID::scale, scaleBox));
     presetAtt.reset(new juce::AudioProcessorValueTreeState::ComboBoxAttachment(apvts, cc::ParamID::progressionPreset, progPresetBox));
     qualityAtt.reset(new juce::AudioProcessorValueTreeState::ComboBoxAttachment(apvts, cc::ParamID::chordQuality, qualityBox));
+    patternAtt.reset(new juce::AudioProcessorValueTreeState::ComboBoxAttachment(apvts, cc::ParamID::pattern, patternBox));
+    patternRateAtt.reset(new juce::AudioProcessorValueTreeState::ComboBoxAttachment(apvts, cc::ParamID::patternRate, patternRateBox));
+    quantizeAtt.reset(new juce::AudioProcessorValueTreeState::ComboBoxAttachment(apvts, cc::ParamID::quantizeInput, quantizeBox));
+    triggerModeAtt.reset(new juce::AudioProcessorValueTreeState::ComboBoxAttachment(apvts, cc::ParamID::triggerMode, triggerModeBox));
+    ccShapeAtt.reset(new juce::AudioProcessorValueTreeState::ComboBoxAttachment(apvts, cc::ParamID::ccShape, ccShapeBox));
+    harmonyRoleAtt.reset(new juce::AudioProcessorValueTreeState::ComboBoxAttachment(apvts, cc::ParamID::harmonyRole, harmonyRoleBox));
 
     velocityAtt.reset(new juce::AudioProcessorValueTreeState::SliderAttachment(apvts, cc::ParamID::velocity, velocitySlider));
     noteLenAtt.reset(new juce::AudioProcessorValueTreeState::SliderAttachment(apvts, cc::ParamID::noteLengthMs, noteLenSlider));
     humanizeMsAtt.reset(new juce::AudioProcessorValueTreeState::SliderAttachment(apvts, cc::ParamID::humanizeMs, humanizeMsSlider));
     humanizeVelAtt.reset(new juce::AudioProcessorValueTreeState::SliderAttachment(apvts, cc::ParamID::humanizeVel, humanizeVelSlider));
     octaveAtt.reset(new juce::AudioProcessorValueTreeState::SliderAttachment(apvts, cc::ParamID::octave, octaveSlider));
+    strumAtt.reset(new juce::AudioProcessorValueTreeState::SliderAttachment(apvts, cc::ParamID::strumMs, strumSlider));
+    ratchetAtt.reset(new juce::AudioProcessorValueTreeState::SliderAttachment(apvts, cc::ParamID::ratchet, ratchetSlider));
+    seedAtt.reset(new juce::AudioProcessorValueTreeState::SliderAttachment(apvts, cc::ParamID::seed, seedSlider));
+    lookAheadMsAtt.reset(new juce::AudioProcessorValueTreeState::SliderAttachment(apvts, cc::ParamID::lookAheadMs, lookAheadSlider));
+    coalesceAtt.reset(new juce::AudioProcessorValueTreeState::SliderAttachment(apvts, cc::ParamID::coalesceMs, coalesceSlider));
+    budgetAtt.reset(new juce::AudioProcessorValueTreeState::SliderAttachment(apvts, cc::ParamID::eventBudget, budgetSlider));
+    splitAtt.reset(new juce::AudioProcessorValueTreeState::SliderAttachment(apvts, cc::ParamID::splitPoint, splitSlider));
+    ccNumberAtt.reset(new juce::AudioProcessorValueTreeState::SliderAttachment(apvts, cc::ParamID::ccNumber, ccNumberSlider));
+    ccThresholdAtt.reset(new juce::AudioProcessorValueTreeState::SliderAttachment(apvts, cc::ParamID::ccThreshold, ccThresholdSlider));
+    previewLevelAtt.reset(new juce::AudioProcessorValueTreeState::SliderAttachment(apvts, cc::ParamID::previewLevel, previewLevelSlider));
+    captureBarsAtt.reset(new juce::AudioProcessorValueTreeState::SliderAttachment(apvts, cc::ParamID::captureBars, captureBarsSlider));
 
     add7Att.reset(new juce::AudioProcessorValueTreeState::ButtonAttachment(apvts, cc::ParamID::add7, add7Toggle));
     add9Att.reset(new juce::AudioProcessorValueTreeState::ButtonAttachment(apvts, cc::ParamID::add9, add9Toggle));
     add11Att.reset(new juce::AudioProcessorValueTreeState::ButtonAttachment(apvts, cc::ParamID::add11, add11Toggle));
     add13Att.reset(new juce::AudioProcessorValueTreeState::ButtonAttachment(apvts, cc::ParamID::add13, add13Toggle));
     followHostAtt.reset(new juce::AudioProcessorValueTreeState::ButtonAttachment(apvts, cc::ParamID::followHost, followHostToggle));
+    clockSyncAtt.reset(new juce::AudioProcessorValueTreeState::ButtonAttachment(apvts, cc::ParamID::clockSync, clockSyncToggle));
+    lookAheadAtt.reset(new juce::AudioProcessorValueTreeState::ButtonAttachment(apvts, cc::ParamID::lookAhead, lookAheadToggle));
+    stormAtt.reset(new juce::AudioProcessorValueTreeState::ButtonAttachment(apvts, cc::ParamID::stormMode, stormToggle));
+    legatoAtt.reset(new juce::AudioProcessorValueTreeState::ButtonAttachment(apvts, cc::ParamID::legato, legatoToggle));
+    previewAtt.reset(new juce::AudioProcessorValueTreeState::ButtonAttachment(apvts, cc::ParamID::previewSynth, previewToggle));
+    multitimbralAtt.reset(new juce::AudioProcessorValueTreeState::ButtonAttachment(apvts, cc::ParamID::multitimbral, multitimbralToggle));
+    wireAtt.reset(new juce::AudioProcessorValueTreeState::ButtonAttachment(apvts, cc::ParamID::wireModel, wireToggle));
+    liveCcAtt.reset(new juce::AudioProcessorValueTreeState::ButtonAttachment(apvts, cc::ParamID::liveCcControl, liveCcToggle));
 
-    generateAtt.reset(new juce::AudioProcessorValueTreeState::ButtonAttachment(apvts, cc::ParamID::generateNow, generateToggle));
-    exportAtt.reset(new juce::AudioProcessorValueTreeState::ButtonAttachment(apvts, cc::ParamID::exportMidi, exportToggle));
+    for (int lane = 0; lane < cc::numExtraLanes; ++lane)
+    {
+        using APVTS = juce::AudioProcessorValueTreeState;
+        auto& r = laneRows[(size_t) lane];
+        r.enabledAtt.reset(new APVTS::ButtonAttachment(apvts, cc::LaneParamID::enabled[lane], r.enabled));
+        r.progressionAtt.reset(new APVTS::ComboBoxAttachment(apvts, cc::LaneParamID::progression[lane], r.progression));
+        r.rateAtt.reset(new APVTS::ComboBoxAttachment(apvts, cc::LaneParamID::rate[lane], r.rate));
+        r.voicingAtt.reset(new APVTS::ComboBoxAttachment(apvts, cc::LaneParamID::voicing[lane], r.voicing));
+        r.gateAtt.reset(new APVTS::SliderAttachment(apvts, cc::LaneParamID::gate[lane], r.gate));
+        r.channelAtt.reset(new APVTS::SliderAttachment(apvts, cc::LaneParamID::channel[lane], r.channel));
+        r.octaveAtt.reset(new APVTS::SliderAttachment(apvts, cc::LaneParamID::octave[lane], r.octave));
+    }
 
     // Binding manual del TextEditor al ValueTree
     progressionCustom.onTextChange = [this]
@@ -83,7 +199,6 @@ ChordCompanionAudioProcessorEditor::ChordCompanionAudioProcessorEditor(ChordComp
         const bool isCustom = (progPresetBox.getSelectedId() - 1) == (int) cc::ProgressionPreset::Custom;
         if (isCustom)
             processor.apvts.state.setProperty(cc::ParamID::progressionCustom, progressionCustom.getText(), nullptr);
-        updateProgressionLabel();
     };
 
     // Interacciones adicionales
@@ -91,53 +206,79 @@ ChordCompanionAudioProcessorEditor::ChordCompanionAudioProcessorEditor(ChordComp
     {
         const bool isCustom = (progPresetBox.getSelectedId() - 1) == (int) cc::ProgressionPreset::Custom;
         progressionCustom.setEnabled(isCustom);
-        updateProgressionLabel();
+        updateSuggestionButtons();
     };
 
-    exportToggle.onClick = [this]
+    // Órdenes al hilo de audio (cola sin bloqueos): ni parámetros del host ni acceso directo al motor
+    generateButton.onClick = [this] { processor.postCommand({ cc::Command::Type::Generate }); };
+    stopButton.onClick     = [this] { processor.postCommand({ cc::Command::Type::Stop }); };
+    auditionButton.onClick = [this] { processor.postCommand({ cc::Command::Type::Audition, -1 }); };
+    reseedButton.onClick   = [this]
     {
-        if (exportToggle.getToggleState())
-        {
-            juce::FileChooser chooser("Export MIDI", juce::File(), "*.mid");
-            chooser.launchAsync(juce::FileBrowserComponent::saveMode | juce::FileBrowserComponent::canSelectFiles,
-                                [this](const juce::FileChooser& fc)
-                                {
-                                    auto file = fc.getResult();
-                                    if (file != juce::File())
-                                        processor.exportProgressionToMidiFile(file);
-
-                                    // resetear flag
-                                    exportToggle.setToggleState(false, juce::dontSendNotification);
-                                    if (auto* p = processor.apvts.getParameter(cc::ParamID::exportMidi))
-                                    {
-                                        p->beginChangeGesture();
-                                        p->setValueNotifyingHost(0.0f);
-                                        p->endChangeGesture();
-                                    }
-                                });
-        }
+        processor.postCommand({ cc::Command::Type::Reseed, juce::Random::getSystemRandom().nextInt({ 1, 1000000 }) });
+    };
+    exportButton.onClick   = [this] { exportMidi(); };
+
+    // Trazado de CPU: no es un parámetro (no automatizable), se controla solo desde el editor
+    traceToggle.setToggleState(processor.getPerfTrace().isEnabled(), juce::dontSendNotification);
+    traceToggle.onClick = [this]
+    {
+        processor.getPerfTrace().setEnabled(traceToggle.getToggleState());
     };
 
-    generateToggle.onClick = [this]
+    dumpTraceButton.onClick = [this]
     {
-        if (generateToggle.getToggleState())
+        const auto name = "ChordCompanion-trace-" + juce::Time::getCurrentTime().formatted("%Y%m%d-%H%M%S") + ".json";
+        const auto dest = juce::File::getSpecialLocation(juce::File::userDocumentsDirectory).getChildFile(name);
+        processor.getPerfTrace().requestDump(dest);
+        dumpTraceButton.setTooltip(dest.getFullPathName());
+    };
+
+    // Grabación de sesión para reproducirla offline (perfilado y bisección de problemas en directo)
+    recordToggle.setToggleState(processor.isRecordingSession(), juce::dontSendNotification);
+    recordToggle.onClick = [this]
+    {
+        if (! recordToggle.getToggleState())
         {
-            processor.triggerGenerateNow();
-            generateToggle.setToggleState(false, juce::dontSendNotification);
-            if (auto* p = processor.apvts.getParameter(cc::ParamID::generateNow))
-            {
-                p->beginChangeGesture();
-                p->setValueNotifyingHost(0.0f);
-                p->endChangeGesture();
-            }
+            processor.stopSessionRecording();
+            return;
         }
+        const auto name = "ChordCompanion-session-" + juce::Time::getCurrentTime().formatted("%Y%m%d-%H%M%S") + ".ccsession";
+        const auto dest = juce::File::getSpecialLocation(juce::File::userDocumentsDirectory).getChildFile(name);
+        if (processor.startSessionRecording(dest))
+            recordToggle.setTooltip(dest.getFullPathName());
+        else
+            recordToggle.setToggleState(false, juce::dontSendNotification);
     };
 
+    // Sugerencias, progresión y secuencia solo cambian con el plan: se refrescan al reconstruirlo
+    suggestions.addChangeListener(this);
+    processor.getPlanBroadcaster().addChangeListener(this);
+    updateProgressionLabel();
+    requestSuggestions();
+    updateSuggestionButtons();
+
+    // Captura de la salida: el clip se rehace en segundo plano al pasar el ratón y cada pocos segundos
+    clipDragSource.onHover = [this] { captureExporter.request((int) captureBarsSlider.getValue()); };
+    clipDragSource.onDragStart = [this]
+    {
+        const auto clip = captureExporter.getClip();
+        if (clip.file.existsAsFile())
+            captureExporter.markDragged();
+        return clip.file;
+    };
+    captureExporter.addChangeListener(this);
+    updateCaptureClip();
+    clipDragSource.onHover();
+
     startTimerHz(10); // refrescar label/estado
 }
 
 ChordCompanionAudioProcessorEditor::~ChordCompanionAudioProcessorEditor()
 {
+    suggestions.removeChangeListener(this);
+    processor.getPlanBroadcaster().removeChangeListener(this);
+    captureExporter.removeChangeListener(this);
     stopTimer();
 }
 
@@ -161,9 +302,12 @@ void ChordCompanionAudioProcessorEditor::resized()
 
     auto row2 = area.removeFromTop(28);
     progressionCustom.setBounds(row2.removeFromLeft(200));
-    followHostToggle.setBounds(row2.removeFromLeft(140));
-    generateToggle.setBounds(row2.removeFromLeft(120));
-    exportToggle.setBounds(row2.removeFromLeft(120));
+    followHostToggle.setBounds(row2.removeFromLeft(120));
+    generateButton.setBounds(row2.removeFromLeft(80).reduced(2, 0));
+    stopButton.setBounds(row2.removeFromLeft(60).reduced(2, 0));
+    auditionButton.setBounds(row2.removeFromLeft(80).reduced(2, 0));
+    reseedButton.setBounds(row2.removeFromLeft(70).reduced(2, 0));
+    exportButton.setBounds(row2.reduced(2, 0));
 
     auto slidersA = area.removeFromTop(28);
     velocitySlider.setBounds(slidersA.removeFromLeft(220));
@@ -173,45 +317,244 @@ void ChordCompanionAudioProcessorEditor::resized()
     auto slidersB = area.removeFromTop(28);
     humanizeMsSlider.setBounds(slidersB.removeFromLeft(220));
     humanizeVelSlider.setBounds(slidersB.removeFromLeft(220));
+    seedSlider.setBounds(slidersB.removeFromLeft(200));
+
+    auto patternRow = area.removeFromTop(28);
+    patternBox.setBounds(patternRow.removeFromLeft(160));
+    patternRateBox.setBounds(patternRow.removeFromLeft(100));
+    strumSlider.setBounds(patternRow.removeFromLeft(200));
+    ratchetSlider.setBounds(patternRow.removeFromLeft(180));
+
+    auto timingRow = area.removeFromTop(28);
+    lookAheadToggle.setBounds(timingRow.removeFromLeft(120));
+    lookAheadSlider.setBounds(timingRow.removeFromLeft(220));
+    quantizeBox.setBounds(timingRow.removeFromLeft(140));
+    clockSyncToggle.setBounds(timingRow.removeFromLeft(120));
+
+    auto triggerRow = area.removeFromTop(28);
+    triggerModeBox.setBounds(triggerRow.removeFromLeft(160));
+    splitSlider.setBounds(triggerRow.removeFromLeft(220));
+    previewToggle.setBounds(triggerRow.removeFromLeft(120));
+    previewLevelSlider.setBounds(triggerRow.removeFromLeft(140));
+
+    auto stormRow = area.removeFromTop(28);
+    stormToggle.setBounds(stormRow.removeFromLeft(120));
+    coalesceSlider.setBounds(stormRow.removeFromLeft(220));
+    budgetSlider.setBounds(stormRow.removeFromLeft(220));
+    wireToggle.setBounds(stormRow.removeFromLeft(100));
+
+    auto ccRow = area.removeFromTop(28);
+    ccShapeBox.setBounds(ccRow.removeFromLeft(160));
+    ccNumberSlider.setBounds(ccRow.removeFromLeft(220));
+    ccThresholdSlider.setBounds(ccRow.removeFromLeft(220));
+    liveCcToggle.setBounds(ccRow.removeFromLeft(100));
+
+    auto captureRow = area.removeFromTop(28);
+    captureBarsSlider.setBounds(captureRow.removeFromLeft(220));
+    clipDragSource.setBounds(captureRow.removeFromLeft(240).reduced(2));
+    multitimbralToggle.setBounds(captureRow.removeFromLeft(120));
 
     auto toggles = area.removeFromTop(28);
     add7Toggle.setBounds(toggles.removeFromLeft(100));
     add9Toggle.setBounds(toggles.removeFromLeft(100));
     add11Toggle.setBounds(toggles.removeFromLeft(100));
     add13Toggle.setBounds(toggles.removeFromLeft(100));
+    legatoToggle.setBounds(toggles.removeFromLeft(100));
+    harmonyRoleBox.setBounds(toggles.removeFromLeft(140));
+
+    for (auto& r : laneRows)
+    {
+        auto laneRow = area.removeFromTop(28);
+        r.enabled.setBounds(laneRow.removeFromLeft(80));
+        r.progression.setBounds(laneRow.removeFromLeft(110));
+        r.rate.setBounds(laneRow.removeFromLeft(70));
+        r.voicing.setBounds(laneRow.removeFromLeft(80));
+        r.gate.setBounds(laneRow.removeFromLeft(110));
+        r.channel.setBounds(laneRow.removeFromLeft(100));
+        r.octave.setBounds(laneRow.removeFromLeft(90));
+    }
 
     progressionLabel.setBounds(area.removeFromTop(22));
+
+    auto suggestionRow = area.removeFromTop(28);
+    for (auto& b : suggestionButtons)
+        b.setBounds(suggestionRow.removeFromLeft(150).reduced(2, 0));
     lastNotesLabel.setBounds(area.removeFromTop(22));
     sequenceLabel.setBounds(area.removeFromTop(22));
+
+    auto perfRow = area.removeFromTop(28);
+    traceToggle.setBounds(perfRow.removeFromLeft(90));
+    dumpTraceButton.setBounds(perfRow.removeFromLeft(110));
+    recordToggle.setBounds(perfRow.removeFromLeft(130));
+    loadLabel.setBounds(perfRow);
 }
 
 void ChordCompanionAudioProcessorEditor::timerCallback()
 {
-    updateProgressionLabel();
     // Refrescar labels de notas
-    lastNotesLabel.setText("Notes: " + processor.apvts.state.getProperty(cc::ParamID::lastChordNotes).toString(), juce::dontSendNotification);
-    sequenceLabel.setText("Sequence: " + processor.apvts.state.getProperty(cc::ParamID::sequenceNotes).toString(), juce::dontSendNotification);
+    cc::ChordNotes chord;
+    if (const auto version = processor.getLastChord().read(chord); version != 0 && version != shownChordVersion)
+    {
+        shownChordVersion = version;
+        lastNotesLabel.setText("Notes: " + cc::notesToString(chord), juce::dontSendNotification);
+    }
+    updateLoadLabel();
+
+    if (++captureRefreshTicks >= 20)
+    {
+        captureRefreshTicks = 0;
+        clipDragSource.onHover();
+    }
+}
+
+void ChordCompanionAudioProcessorEditor::updateLoadLabel()
+{
+    const auto load = processor.getPerfTrace().getLoad();
+    const float percent = load.budgetMicros > 0.0f ? 100.0f * load.averageMicros / load.budgetMicros : 0.0f;
+    juce::String text;
+    text << "Load: avg " << juce::String(load.averageMicros, 1) << " us, max " << juce::String(load.maxMicros, 1)
+         << " us / " << juce::String(load.budgetMicros, 0) << " us (" << juce::String(percent, 2) << "%)";
+    if (load.droppedEvents > 0)
+        text << " - dropped " << load.droppedEvents;
+    if (load.droppedMidiEvents > 0)
+        text << " - MIDI lost " << load.droppedMidiEvents;
+    if (const int lost = processor.getDroppedSessionBlocks(); lost > 0 && processor.isRecordingSession())
+        text << " - rec lost " << lost;
+    if (wireToggle.getToggleState())
+    {
+        const auto& wire = processor.getWireScheduler();
+        text << " - chord skew " << juce::String(wire.getLastChordSkewMs(), 1) << " ms (max "
+             << juce::String(wire.getMaxChordSkewMs(), 1) << ")";
+    }
+    loadLabel.setText(text, juce::dontSendNotification);
 }
 
 void ChordCompanionAudioProcessorEditor::updateProgressionLabel()
 {
-    const int presetIdx = (int) std::lrintf(processor.apvts.getRawParameterValue(cc::ParamID::progressionPreset)->load());
-    const juce::String customStr = processor.apvts.state.getProperty(cc::ParamID::progressionCustom, juce::String("1-5-6-4")).toString();
-    std::vector<int> degrees;
-    if ((cc::ProgressionPreset) presetIdx == cc::ProgressionPreset::Custom)
-        degrees = cc::parseProgressionString(customStr);
+    const auto plan = processor.getProgressionPlan();
+    progressionLabel.setText("Progression: " + plan->roman, juce::dontSendNotification);
+    sequenceLabel.setText("Sequence: " + plan->summary, juce::dontSendNotification);
+}
+
+void ChordCompanionAudioProcessorEditor::requestSuggestions()
+{
+    // El plan se reconstruye al cambiar texto, preset o escala: su versión basta para detectar cambios
+    const auto plan = processor.getProgressionPlan();
+    if (hasRequestedSuggestions && plan->version == suggestedPlanVersion)
+        return;
+    hasRequestedSuggestions = true;
+    suggestedPlanVersion = plan->version;
+
+    const std::vector<int> degrees(plan->degrees.begin(), plan->degrees.begin() + plan->numSteps);
+    suggestions.request(degrees, (cc::ScaleType) plan->inputs.scale);
+}
+
+void ChordCompanionAudioProcessorEditor::changeListenerCallback(juce::ChangeBroadcaster* source)
+{
+    if (source == &captureExporter)
+    {
+        updateCaptureClip();
+        return;
+    }
+    if (source == &processor.getPlanBroadcaster())
+    {
+        updateProgressionLabel();
+        requestSuggestions();
+        return;
+    }
+    shownSuggestions = suggestions.getResults();
+    updateSuggestionButtons();
+}
+
+void ChordCompanionAudioProcessorEditor::updateCaptureClip()
+{
+    const auto clip = captureExporter.getClip();
+    if (clip.numNotes == 0)
+        clipDragSource.setText("Nothing captured yet");
     else
+        clipDragSource.setText("Drag " + juce::String(clip.bars) + " bars (" + juce::String(clip.numNotes) + " notes)");
+}
+
+void ChordCompanionAudioProcessorEditor::ClipDragSource::setText(const juce::String& newText)
+{
+    text = newText;
+    repaint();
+}
+
+void ChordCompanionAudioProcessorEditor::ClipDragSource::paint(juce::Graphics& g)
+{
+    g.setColour(juce::Colours::black.withAlpha(0.3f));
+    g.fillRoundedRectangle(getLocalBounds().toFloat(), 4.0f);
+    g.setColour(juce::Colours::white);
+    g.setFont(13.0f);
+    g.drawText(text, getLocalBounds(), juce::Justification::centred, true);
+}
+
+void ChordCompanionAudioProcessorEditor::ClipDragSource::mouseEnter(const juce::MouseEvent&)
+{
+    if (onHover)
+        onHover();
+}
+
+void ChordCompanionAudioProcessorEditor::ClipDragSource::mouseDrag(const juce::MouseEvent&)
+{
+    if (dragging || ! onDragStart)
+        return;
+    const auto file = onDragStart();
+    if (! file.existsAsFile())
+        return;
+    dragging = true;
+    juce::DragAndDropContainer::performExternalDragDropOfFiles({ file.getFullPathName() }, false, this,
+                                                               [this] { dragging = false; });
+}
+
+void ChordCompanionAudioProcessorEditor::updateSuggestionButtons()
+{
+    const bool isCustom = (progPresetBox.getSelectedId() - 1) == (int) cc::ProgressionPreset::Custom;
+    const bool minor = (cc::ScaleType) processor.getProgressionPlan()->inputs.scale != cc::ScaleType::Major;
+    for (size_t i = 0; i < suggestionButtons.size(); ++i)
     {
-        switch ((cc::ProgressionPreset) presetIdx)
+        auto& b = suggestionButtons[i];
+        if (i < shownSuggestions.size())
         {
-            case cc::ProgressionPreset::I_V_vi_IV: degrees = {1,5,6,4}; break;
-            case cc::ProgressionPreset::ii_V_I:    degrees = {2,5,1}; break;
-            case cc::ProgressionPreset::I_vi_IV_V: degrees = {1,6,4,5}; break;
-            case cc::ProgressionPreset::vi_IV_I_V: degrees = {6,4,1,5}; break;
-            default: degrees = {1,5,6,4}; break;
+            const auto& s = shownSuggestions[i];
+            b.setButtonText("+ " + cc::degreesToRoman(s.toVector(), minor));
+            b.setTooltip("Cost " + juce::String(s.cost, 2));
+            b.setEnabled(isCustom);
+        }
+        else
+        {
+            b.setButtonText({});
+            b.setEnabled(false);
         }
     }
-    const int scaleIdx = processor.apvts.getParameterAsValue(cc::ParamID::scale).toString().getIntValue();
-    const bool minorLike = (cc::ScaleType) scaleIdx != cc::ScaleType::Major;
-    progressionLabel.setText("Progression: " + cc::degreesToRoman(degrees, minorLike), juce::dontSendNotification);
-}
\ No newline at end of file
+}
+
+void ChordCompanionAudioProcessorEditor::appendSuggestion(int index)
+{
+    if (index < 0 || index >= (int) shownSuggestions.size())
+        return;
+
+    juce::StringArray parts;
+    for (int d : shownSuggestions[(size_t) index].toVector())
+        parts.add(juce::String(d));
+
+    auto text = progressionCustom.getText().trim();
+    if (text.isNotEmpty())
+        text << "-";
+    text << parts.joinIntoString("-");
+    progressionCustom.setText(text, true);  // dispara onTextChange -> ValueTree -> nuevo plan
+}
+
+void ChordCompanionAudioProcessorEditor::exportMidi()
+{
+    // La exportación lee el plan en el hilo de mensajes; no toca el estado de reproducción
+    exportChooser = std::make_unique<juce::FileChooser>("Export MIDI", juce::File(), "*.mid");
+    exportChooser->launchAsync(juce::FileBrowserComponent::saveMode | juce::FileBrowserComponent::canSelectFiles,
+                               [this](const juce::FileChooser& fc)
+                               {
+                                   auto file = fc.getResult();
+                                   if (file != juce::File())
+                                       processor.exportProgressionToMidiFile(file);
+                               });
+}
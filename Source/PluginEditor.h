@@ -7,9 +7,11 @@
 #include "PluginProcessor.h"
 #include "Parameters.h"
 #include "Utils.h"
+#include "SuggestionEngine.h"
 
 class ChordCompanionAudioProcessorEditor : public juce::AudioProcessorEditor,
-                                           private juce::Timer
+                                           private juce::Timer,
+                                           private juce::ChangeListener
 {
 public:
     explicit ChordCompanionAudioProcessorEditor(ChordCompanionAudioProcessor&);
@@ -20,27 +22,92 @@ public:
 
 private:
     void timerCallback() override;
+    void changeListenerCallback(juce::ChangeBroadcaster*) override;
     void updateProgressionLabel();
+    void requestSuggestions();
+    void updateSuggestionButtons();
+    void appendSuggestion(int index);
+    void exportMidi();
+
+    std::unique_ptr<juce::FileChooser> exportChooser;
+    void updateLoadLabel();
+    void updateCaptureClip();
+
+    // Arrastre del clip capturado al DAW: el archivo lo prepara el hilo de exportación
+    class ClipDragSource : public juce::Component
+    {
+    public:
+        std::function<void()> onHover;            // al entrar el ratón: refrescar el clip
+        std::function<juce::File()> onDragStart;  // archivo a arrastrar (vacío = nada)
+
+        void setText(const juce::String& newText);
+        void paint(juce::Graphics&) override;
+        void mouseEnter(const juce::MouseEvent&) override;
+        void mouseDrag(const juce::MouseEvent&) override;
+
+    private:
+        juce::String text;
+        bool dragging = false;
+    };
 
     ChordCompanionAudioProcessor& processor;
 
     // Controles
     juce::ComboBox keyBox, scaleBox, progPresetBox, qualityBox, inversionBox;
+    juce::ComboBox patternBox, patternRateBox, quantizeBox, triggerModeBox, ccShapeBox, harmonyRoleBox;
     juce::TextEditor progressionCustom;
     juce::Slider velocitySlider, noteLenSlider, humanizeMsSlider, humanizeVelSlider, octaveSlider;
+    juce::Slider strumSlider, ratchetSlider, seedSlider, lookAheadSlider, coalesceSlider, budgetSlider, splitSlider, ccNumberSlider, ccThresholdSlider, previewLevelSlider;
     juce::ToggleButton add7Toggle {"Add 7"}, add9Toggle {"Add 9"}, add11Toggle {"Add 11"}, add13Toggle {"Add 13"};
     juce::ToggleButton followHostToggle {"Follow Host"};
-    juce::ToggleButton generateToggle {"Generate"};
-    juce::ToggleButton exportToggle {"Export MIDI"};
+    juce::ToggleButton clockSyncToggle {"MIDI Clock"};
+    juce::ToggleButton lookAheadToggle {"Look-Ahead"};
+    juce::ToggleButton stormToggle {"Storm Mode"};
+    juce::ToggleButton legatoToggle {"Legato"};
+    juce::ToggleButton previewToggle {"Preview Synth"};
+    juce::ToggleButton multitimbralToggle {"Multitimbral"};
+    juce::ToggleButton wireToggle {"DIN Wire"};
+    juce::ToggleButton liveCcToggle {"CC 16-19"};
+    juce::ToggleButton traceToggle {"Trace"};
+    juce::TextButton dumpTraceButton {"Dump Trace"};
+    juce::ToggleButton recordToggle {"Record Session"};
+    juce::TextButton generateButton {"Generate"}, stopButton {"Stop"}, auditionButton {"Audition"}, reseedButton {"Reseed"};
+    juce::TextButton exportButton {"Export MIDI"};
+
+    // Carriles extra: una fila de controles por carril
+    struct LaneRow
+    {
+        juce::ToggleButton enabled;
+        juce::ComboBox progression, rate, voicing;
+        juce::Slider gate, channel, octave;
+        std::unique_ptr<juce::AudioProcessorValueTreeState::ButtonAttachment> enabledAtt;
+        std::unique_ptr<juce::AudioProcessorValueTreeState::ComboBoxAttachment> progressionAtt, rateAtt, voicingAtt;
+        std::unique_ptr<juce::AudioProcessorValueTreeState::SliderAttachment> gateAtt, channelAtt, octaveAtt;
+    };
+    std::array<LaneRow, cc::numExtraLanes> laneRows;
+
+    juce::Slider captureBarsSlider;
+    ClipDragSource clipDragSource;
+    cc::CaptureExporter captureExporter;
+    int captureRefreshTicks = 0;
+    juce::uint32 shownChordVersion = 0;  // versión del último acorde ya formateado
 
     juce::Label progressionLabel;
     juce::Label lastNotesLabel;
     juce::Label sequenceLabel;
+    juce::Label loadLabel;
+
+    // Sugerencias de continuación (solo aplicables en modo Custom)
+    cc::SuggestionEngine suggestions;
+    std::vector<cc::Suggestion> shownSuggestions;
+    std::array<juce::TextButton, cc::SuggestionSearch::maxResults> suggestionButtons;
+    juce::uint32 suggestedPlanVersion = 0;
+    bool hasRequestedSuggestions = false;
 
     // Attachments
-    std::unique_ptr<juce::AudioProcessorValueTreeState::ComboBoxAttachment> keyAtt, scaleAtt, presetAtt, qualityAtt;
-    std::unique_ptr<juce::AudioProcessorValueTreeState::SliderAttachment> velocityAtt, noteLenAtt, humanizeMsAtt, humanizeVelAtt, octaveAtt;
-    std::unique_ptr<juce::AudioProcessorValueTreeState::ButtonAttachment> add7Att, add9Att, add11Att, add13Att, followHostAtt, generateAtt, exportAtt;
+    std::unique_ptr<juce::AudioProcessorValueTreeState::ComboBoxAttachment> keyAtt, scaleAtt, presetAtt, qualityAtt, patternAtt, patternRateAtt, quantizeAtt, triggerModeAtt, ccShapeAtt, harmonyRoleAtt;
+    std::unique_ptr<juce::AudioProcessorValueTreeState::SliderAttachment> velocityAtt, noteLenAtt, humanizeMsAtt, humanizeVelAtt, octaveAtt, strumAtt, ratchetAtt, seedAtt, lookAheadMsAtt, coalesceAtt, budgetAtt, splitAtt, ccNumberAtt, ccThresholdAtt, previewLevelAtt, captureBarsAtt;
+    std::unique_ptr<juce::AudioProcessorValueTreeState::ButtonAttachment> add7Att, add9Att, add11Att, add13Att, followHostAtt, clockSyncAtt, lookAheadAtt, stormAtt, legatoAtt, previewAtt, multitimbralAtt, wireAtt, liveCcAtt;
     // No existe TextEditorAttachment en APVTS; se vincula manualmente al ValueTree
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(ChordCompanionAudioProcessorEditor)
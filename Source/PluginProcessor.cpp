@@ -5,6 +5,25 @@
 // Incluir .cpp directamente para asegurar que se compilan en este TU
 // (útil si el proyecto no ha sido re-exportado desde Projucer para añadir nuevos archivos)
 #include "Theory.cpp"
+#include "ChordBatch.cpp"
+#include "Patterns.cpp"
+#include "EventScheduler.cpp"
+#include "StormGuard.cpp"
+#include "MidiClockSync.cpp"
+#include "PreviewSynth.cpp"
+#include "OutputCapture.cpp"
+#include "HarmonyBus.cpp"
+#include "WireScheduler.cpp"
+#include "CcLane.cpp"
+#include "LegatoVoices.cpp"
+#include "ParameterAutomation.cpp"
+#include "MidiDelayLine.cpp"
+#include "BlockEventList.cpp"
+#include "PerfTrace.cpp"
+#include "SessionRecorder.cpp"
+#include "ProgressionPlan.cpp"
+#include "ProgressionLanes.cpp"
+#include "SuggestionEngine.cpp"
 #include "ProgressionEngine.cpp"
 #include "Utils.cpp"
 
@@ -12,23 +31,107 @@ ChordCompanionAudioProcessor::ChordCompanionAudioProcessor()
     : juce::AudioProcessor(BusesProperties()
         .withInput("Input", juce::AudioChannelSet::stereo(), true)
         .withOutput("Output", juce::AudioChannelSet::stereo(), true)),
-      apvts(*this, &undo, "PARAMS", cc::createParameterLayout())
+      apvts(*this, &undo, "PARAMS", cc::createParameterLayout()),
+      automation(apvts),
+      planCache(apvts)
 {
     // Inicializar propiedad de texto para progressionCustom (no es parámetro estándar)
     if (! apvts.state.hasProperty(cc::ParamID::progressionCustom))
         apvts.state.setProperty(cc::ParamID::progressionCustom, juce::String("1-5-6-4"), nullptr);
-    // Inicializa propiedades de notas para la UI
-    if (! apvts.state.hasProperty(cc::ParamID::lastChordNotes))
-        apvts.state.setProperty(cc::ParamID::lastChordNotes, juce::String(), nullptr);
-    if (! apvts.state.hasProperty(cc::ParamID::sequenceNotes))
-        apvts.state.setProperty(cc::ParamID::sequenceNotes, juce::String(), nullptr);
+
+    // El resumen de la secuencia sale del plan: se actualiza en el hilo de mensajes al reconstruirlo
+    apvts.state.setProperty(cc::ParamID::sequenceNotes, planCache.getPlan()->summary, nullptr);
+    planCache.onPlanChanged = [this](const cc::ProgressionPlan& plan)
+    {
+        apvts.state.setProperty(cc::ParamID::sequenceNotes, plan.summary, nullptr);
+    };
 }
 
-ChordCompanionAudioProcessor::~ChordCompanionAudioProcessor() = default;
+ChordCompanionAudioProcessor::~ChordCompanionAudioProcessor()
+{
+    cancelPendingUpdate();
+
+    // Los seguidores dejan de seguir en el acto, sin esperar a que caduque el latido
+    if (wasLeader)
+        cc::HarmonyBus::get().publish({});
+}
+
+static float loadParam(const juce::AudioProcessorValueTreeState& apvts, const juce::String& id)
+{
+    if (auto* p = apvts.getRawParameterValue(id))
+        return p->load();
+    return 0.0f;
+}
+
+static int loadIntParam(const juce::AudioProcessorValueTreeState& apvts, const juce::String& id)
+{
+    return (int) std::lrintf(loadParam(apvts, id));
+}
+
+static bool loadBoolParam(const juce::AudioProcessorValueTreeState& apvts, const juce::String& id)
+{
+    return loadParam(apvts, id) >= 0.5f;
+}
+
+// Rasgos del núcleo de emisión en vivo
+static cc::ChordEmitFlags liveEmitFlags(const cc::LiveSettings& st, bool quantize)
+{
+    cc::ChordEmitFlags f;
+    f.humanize   = st[cc::LiveParam::humanizeMs] > 0 || st[cc::LiveParam::humanizeVel] > 0;
+    f.extensions = cc::chordHasExtensions(st.quality(), st.toggles());
+    f.patterned  = st.pattern() != cc::PatternMode::Block;
+    f.hostSync   = quantize;
+    return f;
+}
+
+// Ajustes de acorde del camino en vivo en el formato del plan (para reutilizar sus acordes memoizados)
+static cc::PlanInputs toPlanInputs(const cc::LiveSettings& st, int preset)
+{
+    cc::PlanInputs in;
+    in.preset    = preset;
+    in.key       = st[cc::LiveParam::key];
+    in.scale     = st[cc::LiveParam::scale];
+    in.quality   = st[cc::LiveParam::chordQuality];
+    in.inversion = st[cc::LiveParam::inversion];
+    in.octave    = st[cc::LiveParam::octave];
+    in.toggles   = st.toggles();
+    return in;
+}
 
 void ChordCompanionAudioProcessor::prepareToPlay(double sampleRate, int /*samplesPerBlock*/)
 {
     engine.prepare(sampleRate);
+    liveEvents.clear();
+    stormGuard.reset();
+    liveCc.reset();
+    channels.reset();
+    lastLiveChannel = 0;
+    midiClock.prepare(sampleRate);
+    clockHeld = false;
+    previewSynth.prepare(sampleRate);
+    previewWasOn = false;
+    wireScheduler.prepare(sampleRate);
+    wireWasOn = false;
+    sampleClock = 0;
+    wasHostPlaying = false;
+    automation.reset();
+    applyRandomSeed(loadIntParam(apvts, cc::ParamID::seed));
+
+    // Buffers de mezcla: dimensionados aquí para no reasignar en processBlock
+    generated.clear();
+    inputScratch.ensureSize((size_t) cc::BlockEventList::maxEvents * (size_t) cc::midiBufferBytesForEvent(3));
+    wireScratch.ensureSize((size_t) (cc::BlockEventList::maxEvents + cc::WireScheduler::maxEvents)
+                           * (size_t) cc::midiBufferBytesForEvent(3));
+
+    delayLine.clear();
+    const int latency = getTargetLatencySamples(sampleRate);
+    requestedLatency = latency;
+    activeLatency = latency;
+    setLatencySamples(latency);
+
+    // Fuerza la construcción de las tablas de patrones y de curvas de CC fuera del hilo de audio
+    cc::getPatternTable(cc::PatternMode::Block, 0);
+    cc::getCcShapeTable(cc::CcShape::Off);
 }
 
 void ChordCompanionAudioProcessor::releaseResources()
@@ -37,187 +140,577 @@ void ChordCompanionAudioProcessor::releaseResources()
 
 bool ChordCompanionAudioProcessor::isBusesLayoutSupported(const BusesLayout& layouts) const
 {
-    // Permite cualquier combinación; el plugin ignora audio
+    // Permite cualquier combinación; la entrada de audio se ignora y la salida solo lleva el sintetizador de previsualización
     juce::ignoreUnused(layouts);
     return true;
 }
 
-static float loadParam(const juce::AudioProcessorValueTreeState& apvts, const juce::String& id)
+int ChordCompanionAudioProcessor::getTargetLatencySamples(double sampleRate) const
 {
-    if (auto* p = apvts.getRawParameterValue(id))
-        return p->load();
-    return 0.0f;
+    if (! loadBoolParam(apvts, cc::ParamID::lookAhead))
+        return 0;
+    return cc::msToSamples(sampleRate, loadIntParam(apvts, cc::ParamID::lookAheadMs));
 }
 
-static int loadIntParam(const juce::AudioProcessorValueTreeState& apvts, const juce::String& id)
+void ChordCompanionAudioProcessor::handleAsyncUpdate()
 {
-    return (int) std::lrintf(loadParam(apvts, id));
+    // setLatencySamples notifica al host: nunca desde el hilo de audio
+    const int latency = requestedLatency.load();
+    setLatencySamples(latency);
+    activeLatency = latency;
 }
 
-static bool loadBoolParam(const juce::AudioProcessorValueTreeState& apvts, const juce::String& id)
+void ChordCompanionAudioProcessor::applyRandomSeed(int seed)
 {
-    return loadParam(apvts, id) >= 0.5f;
+    activeSeed = seed;
+    seedGenerators(seed);
 }
 
-static std::vector<int> getDegreesFromParameters(const juce::AudioProcessorValueTreeState& apvts)
+void ChordCompanionAudioProcessor::seedGenerators(int seed)
 {
-    const int presetIdx = loadIntParam(apvts, cc::ParamID::progressionPreset);
-    const juce::String customStr = apvts.state.getProperty(cc::ParamID::progressionCustom, juce::String("1-5-6-4")).toString();
-    const auto preset = (cc::ProgressionPreset) presetIdx;
-    if (preset == cc::ProgressionPreset::Custom)
-        return cc::parseProgressionString(customStr);
-    switch (preset)
-    {
-        case cc::ProgressionPreset::I_V_vi_IV: return {1,5,6,4};
-        case cc::ProgressionPreset::ii_V_I:    return {2,5,1};
-        case cc::ProgressionPreset::I_vi_IV_V: return {1,6,4,5};
-        case cc::ProgressionPreset::vi_IV_I_V: return {6,4,1,5};
-        default: return {1,5,6,4};
-    }
+    // Flujos distintos para vivo (uno por canal) y cola, todos derivados de la misma semilla (0: aleatoria)
+    channels.seed(juce::jmax(0, seed));
+    engine.setRandomSeed(queueSeedFor(seed));
+}
+
+juce::uint64 ChordCompanionAudioProcessor::queueSeedFor(int seed)
+{
+    return seed > 0 ? (((juce::uint64) seed << 32) | 0x9e37u) : 0;
+}
+
+bool ChordCompanionAudioProcessor::postCommand(const cc::Command& command)
+{
+    // Semilla de la cola antes de un posible Generate posterior: el build la lee en este hilo
+    if (command.type == cc::Command::Type::Reseed)
+        engine.setRandomSeed(queueSeedFor(command.value));
+
+    // La cola se construye en el hilo que ordena (mensajes o replay), nunca en el de audio
+    if (command.type == cc::Command::Type::Generate)
+        engine.buildQueueFromPlan(*planCache.getPlan(), apvts, queueBpm.load(std::memory_order_relaxed), activeLatency.load());
+
+    return commands.push(command);
 }
 
 void ChordCompanionAudioProcessor::processBlock(juce::AudioBuffer<float>& buffer, juce::MidiBuffer& midi)
 {
     juce::ScopedNoDenormals noDenormals;
+    cc::ScopedBlockLoad blockLoad(perfTrace, buffer.getNumSamples(), getSampleRate());
+    cc::ScopedTrace blockTrace(perfTrace, "processBlock");
+    const cc::ScopedPlanAccess plan(planCache);
 
-    // Este plugin no produce audio: limpia el buffer
+    // La salida de audio solo lleva el sintetizador de previsualización (si está activo): parte de silencio
     buffer.clear();
 
-    // One-shot generate/Export mediante flags APVTS
+    juce::AudioPlayHead::PositionInfo pos;
+    const bool hasHost = getHostInfo(pos);
+    if (hasHost)
+        if (auto bpm = pos.getBpm())
+            lastKnownBpm = *bpm;
+
+    // Posición del host para la línea de tiempo de la cola y el grado en vivo
+    cc::TransportPosition transport;
+    transport.playing = hasHost && pos.getIsPlaying();
+    transport.bpm = lastKnownBpm;
+    if (hasHost)
+        if (auto ppq = pos.getPpqPosition())
+        {
+            transport.hasPpq = true;
+            transport.ppq = *ppq;
+        }
+
+    // Sin transporte del host (o parado) manda el reloj MIDI entrante: tempo y posición filtrados por el PLL
+    // Parado (0xFC) o sin pulsos la posición se mantiene con playing = false: la cola anclada se pausa y
+    // suelta sus notas igual que con el transporte del host parado, en vez de seguir libre en samples
+    bool clockDriven = false;
+    if (loadBoolParam(apvts, cc::ParamID::clockSync))
     {
-        auto* genParam = apvts.getParameter(cc::ParamID::generateNow);
-        if (genParam && genParam->getValue() > 0.5f)
+        midiClock.processBlock(midi, sampleClock);
+        const bool hostRolling = transport.playing && transport.hasPpq;
+        if (! hostRolling && midiClock.isLocked(sampleClock))
         {
-            // Construir cola y también preparar resumen de notas
-            engine.buildQueueFromParameters(apvts);
-
-            // Crear resumen de la secuencia
-            auto degrees = getDegreesFromParameters(apvts);
-            const int keyIdx     = loadIntParam(apvts, cc::ParamID::key);
-            const int scaleIdx   = loadIntParam(apvts, cc::ParamID::scale);
-            const int qualityIdx = loadIntParam(apvts, cc::ParamID::chordQuality);
-            const bool add7  = loadBoolParam(apvts, cc::ParamID::add7);
-            const bool add9  = loadBoolParam(apvts, cc::ParamID::add9);
-            const bool add11 = loadBoolParam(apvts, cc::ParamID::add11);
-            const bool add13 = loadBoolParam(apvts, cc::ParamID::add13);
-            const int inversion    = loadIntParam(apvts, cc::ParamID::inversion);
-            const int octave       = loadIntParam(apvts, cc::ParamID::octave);
-
-            const auto scale      = (cc::ScaleType) scaleIdx;
-            const auto quality    = (cc::ChordQuality) qualityIdx;
-            const int keySemitone = keyIdx;
-            cc::ExtensionToggles togg { add7, add9, add11, add13 };
-
-            juce::StringArray chordStrings;
-            for (int deg : degrees)
-            {
-                const int root = cc::degreeToMidi(deg, keySemitone, scale, octave);
-                auto notes = cc::makeChordNotes(root, scale, quality, inversion, togg);
-                chordStrings.add("[" + cc::notesToString(notes) + "]");
-            }
-            apvts.state.setProperty(cc::ParamID::sequenceNotes, chordStrings.joinIntoString(" | "), nullptr);
-            engine.startPlayback();
-            genParam->beginChangeGesture();
-            genParam->setValueNotifyingHost(0.0f);
-            genParam->endChangeGesture();
+            clockDriven = true;
+            clockHeld = true;
+            clockHeldPpq = midiClock.ppqAt(sampleClock);
+            lastKnownBpm = midiClock.getBpm();
+            transport.bpm = lastKnownBpm;
+            transport.playing = midiClock.isRunning();
+            transport.hasPpq = true;
+            transport.ppq = clockHeldPpq;
+        }
+        else if (! hostRolling && clockHeld)
+        {
+            // Enganche perdido: última posición del reloj, parada
+            transport.playing = false;
+            transport.hasPpq = true;
+            transport.ppq = clockHeldPpq;
+        }
+        else if (hostRolling)
+        {
+            clockHeld = false;
+        }
+    }
+    else
+    {
+        clockHeld = false;
+    }
+
+    queueBpm.store(lastKnownBpm, std::memory_order_relaxed);
+
+    // Semilla determinista: se reaplica al cambiar y en cada arranque del transporte,
+    // de modo que dos bounces offline producen exactamente la misma salida
+    {
+        const int seed = loadIntParam(apvts, cc::ParamID::seed);
+        const bool hostPlaying = transport.playing;
+        if (seed != activeSeed || (seed > 0 && hostPlaying && ! wasHostPlaying))
+        {
+            applyRandomSeed(seed);
+            if (seed > 0)
+                channels.restart();
         }
+        wasHostPlaying = hostPlaying;
+    }
 
-        auto* expParam = apvts.getParameter(cc::ParamID::exportMidi);
-        if (expParam && expParam->getValue() > 0.5f)
+    // Look-ahead: si cambia, se pide al hilo de mensajes que reporte la nueva latencia
+    {
+        const int target = getTargetLatencySamples(getSampleRate());
+        if (target != requestedLatency.load())
         {
-            // El editor abrirá el FileChooser; aquí solo reseteamos el flag tras exportar
-            // (Export real se realiza en el editor para interactuar con la UI)
+            requestedLatency = target;
+            triggerAsyncUpdate();
         }
     }
+    const int latency = activeLatency.load();
+
+    // Reproducir cola generada si aplica (a la lista de generados, no a la entrada:
+    // así sus note-ons no se interpretan como disparadores del camino en vivo)
+    generated.clear();
+
+    // Órdenes del editor: se ejecutan aquí, sin notificar al host desde el hilo de audio
+    commands.drain([&](const cc::Command& c)
+    {
+        sessionRecorder.addCommand(c);
+        handleCommand(c, *plan, transport, latency);
+    });
 
-    // Reproducir cola generada si aplica
-    engine.injectQueuedEvents(midi, buffer.getNumSamples());
+    // Grabación de sesión: la entrada aún no se ha tocado
+    sessionRecorder.recordBlock(midi, buffer.getNumSamples(), hasHost ? &pos : nullptr);
+
+    {
+        cc::ScopedTrace trace(perfTrace, "injectQueuedEvents");
+        engine.injectQueuedEvents(generated, buffer.getNumSamples(), transport);
+    }
 
     // Manejo en tiempo real: intercepta NoteOn entrante y genera acorde del grado activo
     // Avanza el índice de grado por barra o por longitud si no hay reloj
-    juce::AudioPlayHead::PositionInfo pos;
-    const bool hasHost = getHostInfo(pos);
-    // BPM disponible en pos si el host lo proporciona (no usado aquí)
-    const int noteLengthMs = loadIntParam(apvts, cc::ParamID::noteLengthMs);
     const bool followHost = loadBoolParam(apvts, cc::ParamID::followHost);
 
+    // Cuantización de note-ons entrantes a la rejilla del host (requiere posición PPQ)
+    const int quantizeIdx = loadIntParam(apvts, cc::ParamID::quantizeInput);
+    const auto blockPpq = clockDriven ? (transport.playing ? juce::Optional<double>(transport.ppq) : juce::Optional<double>())
+                        : (hasHost ? pos.getPpqPosition() : juce::Optional<double>());
+    const bool quantize = quantizeIdx > 0 && blockPpq.hasValue();
+    const double quantizeGridQN = quantize ? cc::patternRateToQuarterNotes((cc::PatternRate) (quantizeIdx - 1)) : 1.0;
+    const double samplesPerQN = getSampleRate() * 60.0 / juce::jmax(1.0, lastKnownBpm);
+
     const int blocksamples = buffer.getNumSamples();
 
-    // Cachear grados para RT
-    cachedDegrees = getDegreesFromParameters(apvts);
-    if (cachedDegrees.empty())
-        cachedDegrees = {1,5,6,4};
-
-    const int keyIdx     = loadIntParam(apvts, cc::ParamID::key);
-    const int scaleIdx   = loadIntParam(apvts, cc::ParamID::scale);
-    const int qualityIdx = loadIntParam(apvts, cc::ParamID::chordQuality);
-    const bool add7  = loadBoolParam(apvts, cc::ParamID::add7);
-    const bool add9  = loadBoolParam(apvts, cc::ParamID::add9);
-    const bool add11 = loadBoolParam(apvts, cc::ParamID::add11);
-    const bool add13 = loadBoolParam(apvts, cc::ParamID::add13);
-    const int inversion    = loadIntParam(apvts, cc::ParamID::inversion);
-    const int velocity     = loadIntParam(apvts, cc::ParamID::velocity);
-    const int humanizeMs   = loadIntParam(apvts, cc::ParamID::humanizeMs);
-    const int humanizeVel  = loadIntParam(apvts, cc::ParamID::humanizeVel);
-    const int octave       = loadIntParam(apvts, cc::ParamID::octave);
-
-    const auto scale      = (cc::ScaleType) scaleIdx;
-    const auto quality    = (cc::ChordQuality) qualityIdx;
-    const int keySemitone = keyIdx;
-    cc::ExtensionToggles togg { add7, add9, add11, add13 };
-
-    juce::Random rng;
-
-    // Determinar avance de grado cuando no hay reloj
-    const int lenSamples = cc::msToSamples(getSampleRate(), noteLengthMs);
-    static int samplesUntilAdvance = 0;
-    samplesUntilAdvance -= blocksamples;
-    if (samplesUntilAdvance <= 0)
+    // Ajustes en vivo: instantánea al inicio del bloque
+    automation.beginBlock();
+
+    // Note-offs de las notas ligadas de un canal (1..16)
+    auto legatoRelease = [this](int channel)
+    {
+        return [this, channel](juce::int64 time, int note) { liveEvents.add(time, juce::MidiMessage::noteOff(channel, note)); };
+    };
+
+    // Multitímbrico: cada canal de entrada lleva su propia progresión y toca en su canal. Sin él solo
+    // existe el canal 0, siempre activo. Al cambiar de modo se sueltan las notas ligadas y se parte de cero.
+    const bool multitimbral = loadBoolParam(apvts, cc::ParamID::multitimbral);
+    if (multitimbral != wasMultitimbral)
+    {
+        for (int slot = 0; slot < cc::ChannelStates::numChannels; ++slot)
+            channels.legato[(size_t) slot].releaseAll(legatoRelease(slot + 1));
+        channels.reset();
+        lastLiveChannel = 0;
+        wasMultitimbral = multitimbral;
+    }
+    if (! multitimbral)
+        channels.active[0] = true;
+
+    // Grados del plan memoizado: sin parsing ni asignaciones por bloque. Un canal con Program Change
+    // usa la tabla estática de su preset.
+    const int presetIdx = loadIntParam(apvts, cc::ParamID::progressionPreset);
+    auto channelPreset = [&](int slot)
     {
-        if (!followHost || !hasHost)
+        const int preset = channels.preset[(size_t) slot];
+        return multitimbral && preset >= 0 ? preset : presetIdx;
+    };
+    auto channelDegrees = [&](int slot, const int*& degreesOut)
+    {
+        return plan->resolveDegrees(toPlanInputs(automation.current(), channelPreset(slot)), degreesOut);
+    };
+
+    // Bus de armonía: un seguidor toma tonalidad, escala y grado del líder mientras éste siga vivo.
+    // Si la lectura no es consistente a la primera se conserva la del bloque anterior.
+    const auto harmonyRole = (cc::HarmonyRole) loadIntParam(apvts, cc::ParamID::harmonyRole);
+    const juce::uint32 nowMs = juce::Time::getMillisecondCounter();
+    if (harmonyRole == cc::HarmonyRole::Follower)
+        cc::HarmonyBus::get().read(busHarmony);
+    const bool following = harmonyRole == cc::HarmonyRole::Follower && busHarmony.isLive(nowMs);
+
+    // Grado activo. Con followHost y transporte en marcha sale de la posición de la canción (un paso por
+    // duración de acorde), así un loop o un salto del cursor tocan el acorde correcto desde el primer sample.
+    // Sin reloj avanza por duración de nota.
+    const int lenMsAtStart = automation.current()[cc::LiveParam::noteLengthMs];
+    const bool followTimeline = followHost && transport.playing && transport.hasPpq;
+    auto degreeAtPpq = [&](double ppq, int numSteps)
+    {
+        double chordLenQN = juce::jmax(1.0e-3, lenMsAtStart * lastKnownBpm / 60000.0);
+        // Con reloj MIDI la duración se ajusta a la rejilla de pulsos: el tempo estimado fluctúa un poco
+        // y no debe mover los cambios de acorde respecto a los pulsos
+        if (clockDriven)
         {
-            currentDegreeIndex = (currentDegreeIndex + 1) % cachedDegrees.size();
-            samplesUntilAdvance = lenSamples;
+            constexpr double tickQN = 1.0 / cc::MidiClockSync::ticksPerQuarter;
+            chordLenQN = juce::jmax(tickQN, std::round(chordLenQN / tickQN) * tickQN);
+        }
+        const auto step = (juce::int64) std::floor(ppq / chordLenQN);
+        return (juce::uint8) (((step % numSteps) + numSteps) % numSteps);
+    };
+    for (int slot = 0; slot < cc::ChannelStates::numChannels; ++slot)
+    {
+        if (! channels.active[(size_t) slot])
+            continue;
+
+        const int* degrees = nullptr;
+        const int numSteps = channelDegrees(slot, degrees);
+        auto& index = channels.degreeIndex[(size_t) slot];
+        auto& countdown = channels.samplesUntilAdvance[(size_t) slot];
+        if (index >= numSteps)
+            index = 0;
+
+        if (followTimeline)
+        {
+            index = degreeAtPpq(transport.ppq, numSteps);
+            countdown = 0;
         }
         else
         {
-            // Si followHost: avanzará por barra/negra según DAW (simplificado aquí)
-            currentDegreeIndex = (currentDegreeIndex + 1) % cachedDegrees.size();
-            samplesUntilAdvance = lenSamples; // aproximación a negra
+            countdown -= blocksamples;
+            if (countdown <= 0)
+            {
+                index = (juce::uint8) ((index + 1) % numSteps);
+                countdown = cc::msToSamples(getSampleRate(), lenMsAtStart);
+            }
         }
     }
 
-    // Iterar mensajes entrantes, generar acordes y preservar otros
-    juce::MidiBuffer output;
-    for (const auto meta : midi)
+    // Modo tormenta: coste por bloque acotado aunque lleguen decenas de note-ons
+    const bool storm = loadBoolParam(apvts, cc::ParamID::stormMode);
+    const int coalesceSamples = cc::msToSamples(getSampleRate(), loadIntParam(apvts, cc::ParamID::coalesceMs));
+    stormGuard.beginBlock(storm, loadIntParam(apvts, cc::ParamID::eventBudget));
+
+    // Modo de disparo: progresión (grado actual), teclado dividido (acorde por tecla) o armonizador
+    // (acorde que contiene la nota); los dos últimos son consultas a tablas del plan
+    const auto triggerMode = (cc::TriggerMode) loadIntParam(apvts, cc::ParamID::triggerMode);
+    const bool keyboardSplit = triggerMode == cc::TriggerMode::KeyboardSplit;
+    const bool harmonizer = triggerMode == cc::TriggerMode::Harmonizer;
+    const int splitPoint = loadIntParam(apvts, cc::ParamID::splitPoint);
+
+    // Curva de CC por acorde (en el canal del último acorde en vivo)
+    const auto ccShape = (cc::CcShape) loadIntParam(apvts, cc::ParamID::ccShape);
+    const int ccNumber = loadIntParam(apvts, cc::ParamID::ccNumber);
+
+    // Legato: las notas comunes entre acordes se ligan; sus note-off pasan por el programador al soltarlas
+    const bool legatoParam = loadBoolParam(apvts, cc::ParamID::legato);
+
+    // Note-ons que no generan acorde: la mezcla descarta los note-ons de la entrada, así que se reinyectan
+    // como generados (o por la línea de retardo con look-ahead, igual que el resto del MIDI)
+    auto forwardInput = [&](const juce::MidiMessageMetadata& meta)
     {
-        const auto msg = meta.getMessage();
-        const int samplePos = meta.samplePosition;
-        if (msg.isNoteOn())
+        if (latency > 0)
+            delayLine.push(sampleClock + meta.samplePosition + latency, meta.data, meta.numBytes);
+        else
+            generated.add(meta.samplePosition, meta.data, meta.numBytes);
+    };
+
+    // Núcleo de emisión especializado para los rasgos activos: se elige al principio del bloque y de nuevo
+    // solo si un CC de la entrada cambia los ajustes en vivo a mitad de bloque
+    LiveChordSink liveSink { liveEvents, stormGuard };
+    auto emitLive = cc::selectChordEmitter<LiveChordSink>(liveEmitFlags(automation.current(), quantize));
+    const bool liveCcControl = loadBoolParam(apvts, cc::ParamID::liveCcControl);
+
+    // Iterar mensajes entrantes y generar acordes; el resto se conserva en la mezcla final
+    bool consumedNoteOns = false;
+    cc::ChordNotes uiChord; // último acorde del bloque: la propiedad de la UI se escribe una sola vez
+    {
+        cc::ScopedTrace trace(perfTrace, "liveChords");
+        for (const auto meta : midi)
         {
-            const int degree = cachedDegrees[currentDegreeIndex];
-            const int root = cc::degreeToMidi(degree, keySemitone, scale, octave);
-            auto notes = cc::makeChordNotes(root, scale, quality, inversion, togg);
-            // Publicar notas actuales para la UI
-            apvts.state.setProperty(cc::ParamID::lastChordNotes, cc::notesToString(notes), nullptr);
-            for (int n : notes)
+            const int samplePos = meta.samplePosition;
+            if (isNoteOn(meta))
             {
-                const int vel = cc::humanizeVelocity(velocity, humanizeVel, rng);
-                const int hOn = cc::humanizeMsToSamples(getSampleRate(), humanizeMs, rng);
-                const int hOff= cc::humanizeMsToSamples(getSampleRate(), humanizeMs, rng);
-
-                output.addEvent(juce::MidiMessage::noteOn(1, n, (juce::uint8) vel), juce::jmax(0, samplePos + hOn));
-                output.addEvent(juce::MidiMessage::noteOff(1, n), juce::jmax(0, samplePos + hOn + lenSamples + hOff));
+                consumedNoteOns = true;
+                const int inputNote = meta.data[1];
+                const int slot = multitimbral ? (meta.data[0] & 0x0f) : 0;
+                const auto ch = (size_t) slot;
+
+                // Teclado dividido: por encima del punto de división la nota pasa tal cual
+                if (keyboardSplit && inputNote >= splitPoint)
+                {
+                    forwardInput(meta);
+                    continue;
+                }
+
+                // Armonizador: la melodía suena junto a su acorde
+                if (harmonizer)
+                    forwardInput(meta);
+
+                // Primer note-on del canal: su progresión arranca en el primer grado (o en el de la posición)
+                const int* degrees = nullptr;
+                const int numSteps = channelDegrees(slot, degrees);
+                if (! channels.active[ch])
+                {
+                    channels.active[ch] = true;
+                    channels.degreeIndex[ch] = followTimeline ? degreeAtPpq(transport.ppq, numSteps) : (juce::uint8) 0;
+                    channels.samplesUntilAdvance[ch] = cc::msToSamples(getSampleRate(), lenMsAtStart);
+                }
+                else if (channels.degreeIndex[ch] >= numSteps)
+                {
+                    channels.degreeIndex[ch] = 0;  // Program Change a una progresión más corta en este bloque
+                }
+
+                // Con reloj MIDI el grado sale de la posición en el sample del note-on: el cambio de acorde
+                // cae en el pulso aunque el bloque empiece antes
+                if (clockDriven && followTimeline)
+                    channels.degreeIndex[ch] = degreeAtPpq(midiClock.ppqAt(sampleClock + samplePos), numSteps);
+
+                const auto& st = automation.current();
+                auto live = toPlanInputs(st, channelPreset(slot));
+                if (following)
+                {
+                    live.key = busHarmony.key;
+                    live.scale = busHarmony.scale;
+                }
+                int harmonyDegree = 0;
+                const auto& chord = harmonizer    ? plan->resolveHarmonyChord(live, inputNote, channels.lastHarmonyDegree[ch], chordScratch, harmonyDegree)
+                                  : keyboardSplit ? plan->resolveKeyChord(live, inputNote, chordScratch)
+                                  : following     ? plan->resolveDegreeChord(live, busHarmony.degree, chordScratch)
+                                                  : plan->resolveChord(live, degrees, channels.degreeIndex[ch], chordScratch);
+                if (chord.isEmpty())
+                {
+                    if (! harmonizer)
+                        forwardInput(meta); // tecla negra en la zona de acordes
+                    continue;               // (o nota cromática en el armonizador: ya reenviada)
+                }
+
+                // Note-ons agrupados con el disparo anterior o sin presupuesto: se consumen sin acorde
+                const juce::int64 earliest = sampleClock + samplePos;
+                if (storm && (! stormGuard.hasBudget() || ! stormGuard.acceptTrigger(earliest, coalesceSamples, slot + 1)))
+                    continue;
+
+                // Pasos del patrón en samples según el tempo conocido.
+                // Con look-ahead el acorde se sitúa 'latency' samples después, y la humanización puede adelantarlo
+                // hasta el instante actual (humanización simétrica en lugar de recortada a 0).
+                // La cuantización desplaza al punto de rejilla más cercano; hacia atrás solo lo que permite el look-ahead.
+                const double sr = getSampleRate();
+                cc::ChordEmitParams params;
+                params.earliest        = earliest;
+                params.start           = earliest + latency;
+                params.length          = cc::msToSamples(sr, st[cc::LiveParam::noteLengthMs]);
+                params.step            = (juce::int64) std::round(cc::patternRateToQuarterNotes(st.patternRate()) * samplesPerQN);
+                params.strum           = cc::msToSamples(sr, st[cc::LiveParam::strumMs]);
+                params.ratchet         = st[cc::LiveParam::ratchet];
+                params.pattern         = st.pattern();
+                params.velocity        = st[cc::LiveParam::velocity];
+                params.humanizeSamples = cc::msToSamples(sr, st[cc::LiveParam::humanizeMs]);
+                params.humanizeVel     = st[cc::LiveParam::humanizeVel];
+                if (quantize)
+                {
+                    params.ppq          = *blockPpq + samplePos / samplesPerQN;
+                    params.gridQN       = quantizeGridQN;
+                    params.samplesPerQN = samplesPerQN;
+                    params.maxEarly     = latency;
+                }
+
+                // Legato solo en bloque y sin ratchet (en arpegios no hay notas comunes simultáneas)
+                const bool tie = legatoParam && params.pattern == cc::PatternMode::Block && params.ratchet <= 1;
+                auto& legato = channels.legato[ch];
+                liveSink.legato = tie ? &legato : nullptr;
+                liveSink.channel = slot + 1;
+                if (tie)
+                    legato.beginChord(params.start, params.humanizeSamples, legatoRelease(slot + 1));
+
+                // Expande el patrón en tiempo absoluto: las notas pueden caer muchos bloques después
+                cc::ChordEmitScratch liveScratch { livePattern, liveHumanize, channels.rng[ch] };
+                const int emitted = emitLive(params, chord, liveScratch, liveSink);
+                if (tie)
+                    legato.endChord(emitted > 0);
+                if (emitted > 0)
+                {
+                    uiChord = chord;
+                    lastLiveChannel = slot;
+                    liveCc.start(params.start, params.length, ccShape, slot + 1, ccNumber);
+                }
+                if (harmonizer)
+                    channels.lastHarmonyDegree[ch] = (juce::uint8) harmonyDegree;
+                if (keyboardSplit)
+                    channels.lastKeyDegree[ch] = (juce::uint8) cc::ProgressionPlan::keyChordDegree(inputNote);
+            }
+            else
+            {
+                // CC 16–19: ajustes en vivo desde este sample; el mensaje sale igualmente
+                if (liveCcControl && meta.numBytes >= 3 && (meta.data[0] & 0xf0) == 0xb0
+                    && automation.applyControlChange(meta.data[1], meta.data[2]))
+                    emitLive = cc::selectChordEmitter<LiveChordSink>(liveEmitFlags(automation.current(), quantize));
+
+                // Multitímbrico: Program Change elige la progresión de su canal (programas 0..4 = presets,
+                // cualquier otro vuelve al preset global). El mensaje sale igualmente.
+                if (multitimbral && meta.numBytes >= 2 && (meta.data[0] & 0xf0) == 0xc0)
+                    channels.preset[(size_t) (meta.data[0] & 0x0f)]
+                        = (juce::int8) (meta.data[1] <= (int) cc::ProgressionPreset::Custom ? meta.data[1] : -1);
+
+                // Look-ahead: el resto del MIDI se retrasa lo mismo que los acordes
+                if (latency > 0)
+                    forwardInput(meta);
             }
         }
+    }
+
+    // Líder: publica el acorde vigente en cada bloque (el latido mantiene vivos a los seguidores)
+    const bool leader = harmonyRole == cc::HarmonyRole::Leader;
+    if (leader)
+    {
+        const auto ch = (size_t) lastLiveChannel;
+        const auto live = toPlanInputs(automation.current(), channelPreset(lastLiveChannel));
+        const int* degrees = nullptr;
+        const int numSteps = channelDegrees(lastLiveChannel, degrees);
+        const int degree = harmonizer    ? (int) channels.lastHarmonyDegree[ch]
+                         : keyboardSplit ? (int) channels.lastKeyDegree[ch]
+                                         : degrees[channels.degreeIndex[ch] % numSteps];
+        if (degree != leaderHarmony.degree || live.key != leaderHarmony.key || live.scale != leaderHarmony.scale)
+            ++leaderHarmony.chordId;
+        leaderHarmony.key = live.key;
+        leaderHarmony.scale = live.scale;
+        leaderHarmony.degree = degree;
+        leaderHarmony.chord = degree > 0 ? plan->resolveDegreeChord(live, degree, chordScratch) : cc::ChordNotes {};
+        leaderHarmony.heartbeatMs = nowMs;
+        cc::HarmonyBus::get().publish(leaderHarmony);
+    }
+    else if (wasLeader)
+    {
+        cc::HarmonyBus::get().publish({});
+    }
+    wasLeader = leader;
+
+    // CC del acorde en curso: como mucho un CC por intervalo de control y bloque
+    {
+        const cc::CcThinning thinning { loadIntParam(apvts, cc::ParamID::ccThreshold),
+                                        cc::msToSamples(getSampleRate(), cc::CcLane::minIntervalMs) };
+        liveCc.render(sampleClock, blocksamples, thinning, blocksamples / cc::CcLane::controlInterval + 2,
+                      [this](juce::int64 t, int channel, int controller, int value)
+                      {
+                          generated.add((int) (t - sampleClock), juce::MidiMessage::controllerEvent(channel, controller, value));
+                      });
+    }
+
+    // Publicar notas actuales para la UI (el editor las formatea en su timer)
+    if (! uiChord.isEmpty())
+        lastChord.publish(uiChord);
+
+    // Notas ligadas que terminan en este bloque: su note-off entra en el programador antes de emitir
+    for (int slot = 0; slot < cc::ChannelStates::numChannels; ++slot)
+        if (channels.active[(size_t) slot])
+            channels.legato[(size_t) slot].releaseBefore(sampleClock + blocksamples, legatoRelease(slot + 1));
+
+    // Emitir las notas programadas y el MIDI retrasado que caen en este bloque.
+    // En modo tormenta no se re-disparan notas que ya suenan.
+    delayLine.emitBlock(generated, sampleClock, blocksamples);
+    if (storm)
+        liveEvents.emitBlock(generated, sampleClock, blocksamples,
+                             [this](const juce::uint8* data, int size) { return stormGuard.passesSoundingFilter(data, size); });
+    else
+        liveEvents.emitBlock(generated, sampleClock, blocksamples);
+    sampleClock += blocksamples;
+    perfTrace.addDroppedMidi(liveEvents.takeDropped() + delayLine.takeDropped() + generated.takeDropped());
+
+    // Sin note-ons, sin generados y sin retardo la salida es idéntica a la entrada: no se toca
+    if (consumedNoteOns || latency > 0 || ! generated.isEmpty())
+        mergeGeneratedInto(midi, latency > 0);
+
+    // Cable DIN: acordes ordenados (note-offs, controles, note-ons de grave a agudo) y repartidos al ritmo
+    // del puerto en lugar de salir en ráfaga; lo que no cabe en el bloque sale en los siguientes
+    const bool wire = loadBoolParam(apvts, cc::ParamID::wireModel);
+    if (wire)
+    {
+        cc::ScopedTrace trace(perfTrace, "wireScheduler");
+        wireScheduler.process(midi, wireScratch, sampleClock - blocksamples, blocksamples);
+    }
+    else if (wireWasOn)
+    {
+        wireScheduler.flush(midi, wireScratch);
+    }
+    wireWasOn = wire;
+
+    // Todo lo que sale, tal como sale (humanización y disparos en vivo incluidos)
+    outputCapture.captureBlock(midi, blocksamples, getSampleRate(), transport.bpm);
+
+    // Previsualización: el sintetizador toca exactamente lo que sale por MIDI
+    const bool preview = loadBoolParam(apvts, cc::ParamID::previewSynth);
+    if (preview)
+    {
+        cc::ScopedTrace trace(perfTrace, "previewSynth");
+        previewSynth.render(buffer, midi, (float) loadIntParam(apvts, cc::ParamID::previewLevel) / 100.0f);
+    }
+    else if (previewWasOn)
+    {
+        previewSynth.reset();  // al reactivarlo no quedan voces colgadas de antes
+    }
+    previewWasOn = preview;
+}
+
+void ChordCompanionAudioProcessor::mergeGeneratedInto(juce::MidiBuffer& midi, bool dropIncoming)
+{
+    cc::ScopedTrace trace(perfTrace, "mergeOutput");
+    generated.sort();
+
+    // Copia lineal de la entrada (bytes crudos) y reescritura de 'midi' en una sola pasada ordenada:
+    // entrada (sin los note-ons consumidos) + generados. Con look-ahead la entrada ya va en 'generated'.
+    inputScratch.clear();
+    if (! dropIncoming)
+        inputScratch.data.addArray(midi.data.begin(), midi.data.size());
+    midi.clear();
+
+    // appendInOrder escribe directamente en midi.data: se reserva de una vez lo que ocupará la mezcla
+    // (el buffer del host conserva la capacidad, así que solo asigna si el host lo dio pequeño)
+    midi.ensureSize((size_t) inputScratch.data.size() + (size_t) generated.getNumBytes()
+                    + (size_t) generated.size() * (size_t) cc::midiBufferBytesForEvent(0));
+
+    auto in = inputScratch.begin();
+    const auto inEnd = inputScratch.end();
+    int g = 0;
+    const int numGenerated = generated.size();
+
+    for (;;)
+    {
+        while (in != inEnd && isNoteOn(*in))
+            ++in;
+
+        const bool hasIn = in != inEnd;
+        if (! hasIn && g >= numGenerated)
+            break;
+
+        if (hasIn && (g >= numGenerated || (*in).samplePosition <= generated[g].samplePosition))
+        {
+            const auto meta = *in;
+            cc::appendInOrder(midi, meta.samplePosition, meta.data, meta.numBytes);
+            ++in;
+        }
         else
         {
-            // Preservar clock/CC/otros
-            output.addEvent(msg, samplePos);
+            const auto& e = generated[g++];
+            cc::appendInOrder(midi, e.samplePosition, generated.getData(e), e.size);
         }
     }
-
-    midi.swapWith(output);
 }
 
 bool ChordCompanionAudioProcessor::getHostInfo(juce::AudioPlayHead::PositionInfo& outInfo) const
@@ -237,13 +730,136 @@ bool ChordCompanionAudioProcessor::exportProgressionToMidiFile(const juce::File&
 {
     // Algunas versiones de JUCE no exponen BPM en PositionInfo; usamos 120 por defecto.
     double bpm = 120.0;
-    return engine.exportProgressionToMidiFile(apvts, dest, bpm);
+    return engine.exportProgressionToMidiFile(*planCache.getPlan(), apvts, dest, bpm);
+}
+
+bool ChordCompanionAudioProcessor::startSessionRecording(const juce::File& dest)
+{
+    cc::SessionHeader header;
+    header.sampleRate = getSampleRate() > 0.0 ? getSampleRate() : 44100.0;
+    header.maxBlockSize = getBlockSize() > 0 ? getBlockSize() : 512;
+    header.customProgression = apvts.state.getProperty(cc::ParamID::progressionCustom).toString();
+
+    juce::Array<juce::AudioProcessorParameter*> params;
+    for (auto* param : getParameters())
+    {
+        if (auto* withID = dynamic_cast<juce::AudioProcessorParameterWithID*>(param))
+        {
+            header.paramIDs.add(withID->paramID);
+            params.add(param);
+        }
+    }
+    return sessionRecorder.start(dest, header, params);
+}
+
+bool ChordCompanionAudioProcessor::replaySession(const juce::File& source, ReplayStats& stats)
+{
+    stats = {};
+    cc::SessionReader reader;
+    if (! reader.open(source))
+        return false;
+    const auto& header = reader.getHeader();
+
+    cc::ReplayBlock block;
+    if (! reader.next(block))
+        return false;
+
+    ChordCompanionAudioProcessor p;
+    p.apvts.state.setProperty(cc::ParamID::progressionCustom, header.customProgression, nullptr);
+
+    // Índice de la grabación -> parámetro de esta instancia (ids desconocidos se ignoran)
+    std::vector<juce::AudioProcessorParameter*> params;
+    for (const auto& id : header.paramIDs)
+        params.push_back(p.apvts.getParameter(id));
+
+    auto applyParams = [&params, &p](const cc::ReplayBlock& b)
+    {
+        for (const auto& [index, value] : b.paramChanges)
+            if (index < (int) params.size() && params[(size_t) index] != nullptr)
+                params[(size_t) index]->setValue(value);
+        // Sin hilo de mensajes que lo haga: el plan se reconstruye aquí, fuera de la medición
+        if (! b.paramChanges.empty())
+            p.planCache.rebuildNow();
+    };
+
+    cc::ReplayPlayHead playHead;
+    p.setPlayHead(&playHead);
+    p.setRateAndBufferSizeDetails(header.sampleRate, header.maxBlockSize);
+    applyParams(block);
+    p.prepareToPlay(header.sampleRate, header.maxBlockSize);
+
+    juce::AudioBuffer<float> buffer(2, header.maxBlockSize);
+    juce::uint64 hash = 14695981039346656037ull;
+    do
+    {
+        if (stats.blocks > 0)
+            applyParams(block);
+        for (const auto& c : block.commands)
+            p.postCommand(c);
+        playHead.block = &block;
+
+        const int numSamples = juce::jlimit(1, header.maxBlockSize, block.numSamples);
+        buffer.setSize(2, numSamples, false, false, true);
+
+        const auto start = juce::Time::getHighResolutionTicks();
+        p.processBlock(buffer, block.midi);
+        const double micros = juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - start) * 1.0e6;
+
+        stats.totalMicros += micros;
+        stats.maxMicros = juce::jmax(stats.maxMicros, micros);
+        stats.droppedBlocks += (int) block.droppedBefore;
+        ++stats.blocks;
+        for (const auto meta : block.midi)
+        {
+            ++stats.outputEvents;
+            auto mix = [&hash](juce::uint8 byte) { hash = (hash ^ byte) * 1099511628211ull; };
+            for (int i = 0; i < 4; ++i)
+                mix((juce::uint8) (meta.samplePosition >> (8 * i)));
+            for (int i = 0; i < meta.numBytes; ++i)
+                mix(meta.data[i]);
+        }
+    }
+    while (reader.next(block));
+
+    stats.outputHash = hash;
+    p.setPlayHead(nullptr);
+    return true;
 }
 
-void ChordCompanionAudioProcessor::triggerGenerateNow()
+void ChordCompanionAudioProcessor::handleCommand(const cc::Command& command, const cc::ProgressionPlan& plan,
+                                                 const cc::TransportPosition& transport, int latency)
 {
-    engine.buildQueueFromParameters(apvts);
-    engine.startPlayback();
+    switch (command.type)
+    {
+        case cc::Command::Type::Generate:
+        {
+            // La cola ya la construyó postCommand: aquí solo se intercambia y se ancla al transporte
+            engine.startPlayback(transport);
+            break;
+        }
+
+        case cc::Command::Type::Stop:
+            engine.stopPlayback(generated);
+            break;
+
+        case cc::Command::Type::Audition:
+        {
+            // Acorde memoizado del paso pedido, en bloque y con la duración/velocidad actuales
+            const int step = command.value >= 0 ? command.value : (int) channels.degreeIndex[0];
+            const auto& chord = plan.chords[(size_t) (step % plan.numSteps)];
+            const juce::int64 on = sampleClock + latency;
+            const juce::int64 off = on + cc::msToSamples(getSampleRate(), loadIntParam(apvts, cc::ParamID::noteLengthMs));
+            const int velocity = loadIntParam(apvts, cc::ParamID::velocity);
+            for (int note : chord)
+                liveEvents.addNote(on, off, 1, note, velocity);
+            break;
+        }
+
+        case cc::Command::Type::Reseed:
+            // Solo los generadores: el parámetro "seed" sigue siendo la semilla activa
+            seedGenerators(command.value);
+            break;
+    }
 }
 
 void ChordCompanionAudioProcessor::getStateInformation(juce::MemoryBlock& destData)
@@ -7,9 +7,31 @@
 #include "Parameters.h"
 #include "Theory.h"
 #include "Utils.h"
+#include "Patterns.h"
+#include "EventScheduler.h"
+#include "StormGuard.h"
+#include "FastRandom.h"
+#include "ChordEmitter.h"
+#include "ParameterAutomation.h"
+#include "MidiDelayLine.h"
+#include "BlockEventList.h"
+#include "PerfTrace.h"
+#include "ProgressionPlan.h"
 #include "ProgressionEngine.h"
+#include "CommandQueue.h"
+#include "CcLane.h"
+#include "LegatoVoices.h"
+#include "SessionRecorder.h"
+#include "MidiClockSync.h"
+#include "PreviewSynth.h"
+#include "OutputCapture.h"
+#include "HarmonyBus.h"
+#include "ChannelStates.h"
+#include "WireScheduler.h"
+#include "ChordMailbox.h"
 
-class ChordCompanionAudioProcessor : public juce::AudioProcessor
+class ChordCompanionAudioProcessor : public juce::AudioProcessor,
+                                     private juce::AsyncUpdater
 {
 public:
     ChordCompanionAudioProcessor();
@@ -46,15 +68,127 @@ public:
     // Exportación (usado por Editor)
     bool exportProgressionToMidiFile(const juce::File& dest);
 
-    // One-shot Generate desde Editor (opcional)
-    void triggerGenerateNow();
+    // Órdenes del editor (hilo de mensajes); se ejecutan al principio del siguiente bloque.
+    // Generate construye aquí la cola y el audio solo la intercambia. false si la cola está llena.
+    bool postCommand(const cc::Command& command);
+
+    // Plan de progresión actual (hilo de mensajes; usado por Editor)
+    std::shared_ptr<const cc::ProgressionPlan> getProgressionPlan() const { return planCache.getPlan(); }
+    juce::ChangeBroadcaster& getPlanBroadcaster() noexcept { return planCache; }
+
+    // Trazado de CPU y medidor de carga (usado por Editor)
+    cc::PerfTrace& getPerfTrace() { return perfTrace; }
+    const cc::OutputCapture& getOutputCapture() const { return outputCapture; }
+    const cc::WireScheduler& getWireScheduler() const { return wireScheduler; }
+    const cc::ChordMailbox& getLastChord() const { return lastChord; }
+
+    // Grabación de la sesión (hilo de mensajes): entrada, posición, parámetros y órdenes de cada bloque
+    bool startSessionRecording(const juce::File& dest);
+    void stopSessionRecording() { sessionRecorder.stop(); }
+    bool isRecordingSession() const { return sessionRecorder.isRecording(); }
+    int getDroppedSessionBlocks() const { return sessionRecorder.getDroppedBlocks(); }
+
+    struct ReplayStats
+    {
+        int blocks = 0;
+        int droppedBlocks = 0;      // bloques que no llegaron a grabarse (ring lleno)
+        int outputEvents = 0;
+        double totalMicros = 0.0;   // solo processBlock
+        double maxMicros = 0.0;
+        juce::uint64 outputHash = 0; // FNV-1a de la salida: compara ejecuciones y builds
+    };
+
+    // Reproduce una grabación en una instancia nueva, sin editor ni host y a toda velocidad.
+    // La salida es determinista si la sesión usaba semilla fija (con semilla 0 la humanización varía).
+    static bool replaySession(const juce::File& source, ReplayStats& stats);
 
 private:
+    cc::PerfTrace perfTrace;
     cc::ProgressionEngine engine;
+    cc::ParameterAutomation automation; // ajustes en vivo: instantánea por bloque
+    cc::ProgressionPlanCache planCache; // grados + acordes, reconstruido solo cuando cambian
+    cc::CommandQueue commands;          // editor -> audio (generate, stop, audition, reseed)
+    cc::SessionRecorder sessionRecorder;
+
+    // Tracking de progresión en tiempo real: grado, humanización y notas ligadas por canal de entrada
+    // (sin modo multitímbrico solo se usa el canal 0)
+    cc::ChannelStates channels;
+    int lastLiveChannel = 0;     // canal del último acorde en vivo (el que publica el líder del bus)
+    bool wasMultitimbral = false;
+    cc::ChordNotes chordScratch; // acorde recalculado si el plan aún no refleja un cambio
+    cc::ChordMailbox lastChord;  // último acorde en vivo, para la UI
+
+    // Notas en vivo programadas en tiempo absoluto (patrones y note-offs que caen en bloques posteriores)
+    cc::EventScheduler liveEvents;
+    cc::PatternNotes livePattern;
+    juce::int64 sampleClock = 0;  // samples procesados desde prepareToPlay
+    double lastKnownBpm = 120.0;  // último tempo del host (120 si nunca se recibió)
+    std::atomic<double> queueBpm { 120.0 }; // lastKnownBpm para construir la cola en el hilo de mensajes
+    cc::StormGuard stormGuard;    // ráfagas de note-ons (modo tormenta)
+    cc::CcLane liveCc;            // curva de CC del último acorde en vivo
+    cc::MidiClockSync midiClock;  // reloj MIDI entrante: sustituye al transporte del host si no lo hay
+    bool clockHeld = false;       // el reloj ha llevado la posición: parado o perdido, se mantiene en clockHeldPpq
+    double clockHeldPpq = 0.0;
+    cc::PreviewSynth previewSynth; // toca la salida MIDI en el bus de audio (opcional)
+    bool previewWasOn = false;
+    cc::OutputCapture outputCapture; // últimos compases de salida para arrastrarlos al DAW
+    cc::WireScheduler wireScheduler;   // salida repartida al ritmo de un puerto DIN (opcional)
+    juce::MidiBuffer wireScratch;
+    bool wireWasOn = false;
+
+    // Bus de armonía entre instancias: lo publicado como líder y la última lectura como seguidor
+    cc::HarmonySnapshot leaderHarmony;
+    cc::HarmonySnapshot busHarmony;
+    bool wasLeader = false;
+
+    // Humanización: generadores por canal (en 'channels'), sembrables desde el parámetro "seed"
+    cc::HumanizeBatch liveHumanize;
+    int activeSeed = -1;          // semilla aplicada (-1 = ninguna todavía)
+    bool wasHostPlaying = false;
+
+    void applyRandomSeed(int seed);
+    void seedGenerators(int seed);
+
+    static juce::uint64 queueSeedFor(int seed);
+    void handleCommand(const cc::Command& command, const cc::ProgressionPlan& plan,
+                       const cc::TransportPosition& transport, int latency);
+
+    // Destino de los núcleos de emisión en vivo: programador + presupuesto del modo tormenta.
+    // Con 'legato' las notas ligadas no se re-atacan y los note-off los programa el LegatoVoices del canal al soltarlas.
+    struct LiveChordSink
+    {
+        cc::EventScheduler& events;
+        cc::StormGuard& guard;
+        cc::LegatoVoices* legato = nullptr;
+        int channel = 1;
+
+        bool reserve(int numEvents) { return guard.tryReserve(numEvents); }
+        void note(juce::int64 on, juce::int64 off, int note, int velocity)
+        {
+            if (legato == nullptr)
+                events.addNote(on, off, channel, note, velocity);
+            else if (legato->noteOn(note, off))
+                events.add(on, juce::MidiMessage::noteOn(channel, note, (juce::uint8) juce::jlimit(1, 127, velocity)));
+        }
+    };
+
+    // Look-ahead: la salida se retrasa 'activeLatency' samples y se reporta al host como latencia.
+    // El cambio de latencia se notifica desde el hilo de mensajes (handleAsyncUpdate).
+    cc::MidiDelayLine delayLine;
+    std::atomic<int> requestedLatency { 0 };
+    std::atomic<int> activeLatency { 0 };
+    int getTargetLatencySamples(double sampleRate) const;
+    void handleAsyncUpdate() override;
+
+    // Mezcla de salida: eventos generados del bloque (ordenados) + copia de la entrada, preasignados
+    cc::BlockEventList generated;
+    juce::MidiBuffer inputScratch;
+    void mergeGeneratedInto(juce::MidiBuffer& midi, bool dropIncoming);
 
-    // Tracking de progresión en tiempo real
-    size_t currentDegreeIndex = 0;
-    std::vector<int> cachedDegrees; // cache de preset/custom
+    static bool isNoteOn(const juce::MidiMessageMetadata& meta)
+    {
+        return meta.numBytes >= 3 && (meta.data[0] & 0xf0) == 0x90 && meta.data[2] != 0;
+    }
 
     // Utilidad para leer posición del host (API moderna)
     bool getHostInfo(juce::AudioPlayHead::PositionInfo& outInfo) const;
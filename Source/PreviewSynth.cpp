@@ -0,0 +1,217 @@
+// PreviewSynth.cpp
+
+#include "PreviewSynth.h"
+
+namespace cc
+{
+    void PreviewSynth::prepare(double newSampleRate)
+    {
+        sampleRate = newSampleRate;
+        attackCoeff = 1.0f - std::exp(-1.0f / (float) (attackMs * 0.001 * sampleRate));
+        releaseCoeff = 1.0f - std::exp(-1.0f / (float) (releaseMs * 0.001 * sampleRate));
+        reset();
+    }
+
+    void PreviewSynth::reset()
+    {
+        phase.fill(0);
+        increment.fill(0);
+        env.fill(0.0f);
+        target.fill(0.0f);
+        coeff.fill(0.0f);
+        panLeft.fill(0.0f);
+        panRight.fill(0.0f);
+        voiceNote.fill(-1);
+        voiceChannel.fill(0);
+        released.fill(true);
+        startedAt.fill(0);
+        noteCounter = 0;
+        activeGroups = 0;
+        lastGain = -1.0f;
+    }
+
+    int PreviewSynth::getNumActiveVoices() const
+    {
+        int n = 0;
+        for (auto note : voiceNote)
+            n += note >= 0 ? 1 : 0;
+        return n;
+    }
+
+    void PreviewSynth::noteOn(int channel, int note, int velocity)
+    {
+        // Re-disparo de la misma nota, voz libre o, si no hay, la liberada más silenciosa / la más antigua
+        int voice = -1;
+        for (int v = 0; v < maxVoices && voice < 0; ++v)
+            if (voiceNote[(size_t) v] == note && voiceChannel[(size_t) v] == channel)
+                voice = v;
+        for (int v = 0; v < maxVoices && voice < 0; ++v)
+            if (voiceNote[(size_t) v] < 0)
+                voice = v;
+        if (voice < 0)
+        {
+            float quietest = 2.0f;
+            juce::uint32 oldest = std::numeric_limits<juce::uint32>::max();
+            for (int v = 0; v < maxVoices; ++v)
+            {
+                const auto i = (size_t) v;
+                if (released[i] && env[i] < quietest)
+                {
+                    quietest = env[i];
+                    voice = v;
+                }
+            }
+            for (int v = 0; v < maxVoices && quietest > 1.0f; ++v)
+                if (startedAt[(size_t) v] < oldest)
+                {
+                    oldest = startedAt[(size_t) v];
+                    voice = v;
+                }
+        }
+
+        const auto i = (size_t) voice;
+        const bool retrigger = voiceNote[i] >= 0;
+        voiceNote[i] = (juce::int16) note;
+        voiceChannel[i] = (juce::int8) channel;
+        released[i] = false;
+        startedAt[i] = ++noteCounter;
+
+        if (! retrigger)
+            phase[i] = 0;  // el seno empieza en cero: sin clic
+        const double hz = 440.0 * std::pow(2.0, (note - 69) / 12.0);
+        increment[i] = (juce::uint32) (juce::jmin(0.5, hz / sampleRate) * 4294967296.0);
+
+        // Margen para 'maxVoices' voces sumadas; panorama según la altura (graves a la izquierda)
+        target[i] = 0.08f * (float) velocity / 127.0f;
+        coeff[i] = attackCoeff;
+        const float pan = juce::jlimit(0.0f, 1.0f, 0.5f + (float) (note - 60) / 96.0f) * juce::MathConstants<float>::halfPi;
+        panLeft[i] = std::cos(pan);
+        panRight[i] = std::sin(pan);
+
+        activeGroups = juce::jmax(activeGroups, voice / groupSize + 1);
+    }
+
+    void PreviewSynth::noteOff(int channel, int note)
+    {
+        for (int v = 0; v < activeGroups * groupSize; ++v)
+        {
+            const auto i = (size_t) v;
+            if (voiceNote[i] == note && voiceChannel[i] == channel && ! released[i])
+            {
+                released[i] = true;
+                target[i] = 0.0f;
+                coeff[i] = releaseCoeff;
+            }
+        }
+    }
+
+    void PreviewSynth::allNotesOff(int channel)
+    {
+        for (int v = 0; v < activeGroups * groupSize; ++v)
+        {
+            const auto i = (size_t) v;
+            if (voiceNote[i] >= 0 && voiceChannel[i] == channel)
+            {
+                released[i] = true;
+                target[i] = 0.0f;
+                coeff[i] = releaseCoeff;
+            }
+        }
+    }
+
+    void PreviewSynth::renderSegment(float* left, float* right, int start, int numSamples)
+    {
+        if (activeGroups == 0)
+            return;
+
+        // Solo los grupos con voces: el recorrido es un múltiplo del ancho del registro
+        const int numVoices = activeGroups * groupSize;
+
+        for (int s = start; s < start + numSamples; ++s)
+        {
+            alignas(32) float outL[maxVoices], outR[maxVoices];
+
+            // Sin saltos ni llamadas y con los arrays del banco indexados directamente (el compilador sabe que
+            // no se solapan): se vectoriza a lo ancho de las voces sin comprobaciones en tiempo de ejecución
+            for (int v = 0; v < numVoices; ++v)
+            {
+                // Seno parabólico: x en [-1, 1), y = 4x(1 - |x|)
+                const float x = (float) (juce::int32) phase[(size_t) v] * (1.0f / 2147483648.0f);
+                const float y = 4.0f * x * (1.0f - std::abs(x));
+                env[(size_t) v] += (target[(size_t) v] - env[(size_t) v]) * coeff[(size_t) v];
+                const float out = y * env[(size_t) v];
+                outL[v] = out * panLeft[(size_t) v];
+                outR[v] = out * panRight[(size_t) v];
+                phase[(size_t) v] += increment[(size_t) v];
+            }
+
+            float l = 0.0f, r = 0.0f;
+            for (int v = 0; v < numVoices; ++v)
+            {
+                l += outL[v];
+                r += outR[v];
+            }
+            left[s] += l;
+            if (right != nullptr)
+                right[s] += r;
+        }
+
+        // Voces liberadas que ya no se oyen: libres, y los grupos vacíos del final dejan de procesarse
+        int lastActive = -1;
+        for (int v = 0; v < numVoices; ++v)
+        {
+            const auto i = (size_t) v;
+            if (voiceNote[i] < 0)
+                continue;
+            if (released[i] && env[i] < silence)
+            {
+                voiceNote[i] = -1;
+                env[i] = 0.0f;
+                target[i] = 0.0f;
+                increment[i] = 0;
+                continue;
+            }
+            lastActive = v;
+        }
+        activeGroups = lastActive < 0 ? 0 : lastActive / groupSize + 1;
+    }
+
+    void PreviewSynth::render(juce::AudioBuffer<float>& buffer, const juce::MidiBuffer& midi, float gain)
+    {
+        const int numSamples = buffer.getNumSamples();
+        if (buffer.getNumChannels() == 0 || numSamples == 0)
+            return;
+
+        float* const left = buffer.getWritePointer(0);
+        float* const right = buffer.getNumChannels() > 1 ? buffer.getWritePointer(1) : nullptr;
+
+        // Cada evento cambia el banco en su sample: se renderiza por tramos entre eventos
+        int rendered = 0;
+        for (const auto meta : midi)
+        {
+            const int at = juce::jlimit(0, numSamples, meta.samplePosition);
+            if (at > rendered)
+            {
+                renderSegment(left, right, rendered, at - rendered);
+                rendered = at;
+            }
+
+            const auto msg = meta.getMessage();
+            if (msg.isNoteOn())
+                noteOn(msg.getChannel(), msg.getNoteNumber(), msg.getVelocity());
+            else if (msg.isNoteOff())
+                noteOff(msg.getChannel(), msg.getNoteNumber());
+            else if (msg.isAllNotesOff() || msg.isAllSoundOff())
+                allNotesOff(msg.getChannel());
+        }
+        if (rendered < numSamples)
+            renderSegment(left, right, rendered, numSamples - rendered);
+
+        // Volumen en rampa por bloque (el buffer llega limpio: solo contiene el sintetizador)
+        if (lastGain < 0.0f)
+            lastGain = gain;
+        for (int ch = 0; ch < juce::jmin(2, buffer.getNumChannels()); ++ch)
+            buffer.applyGainRamp(ch, 0, numSamples, lastGain, gain);
+        lastGain = gain;
+    }
+}
@@ -0,0 +1,64 @@
+// PreviewSynth.h
+// Sintetizador de previsualización: toca la salida MIDI del plugin en el bus de audio (que si no va en
+// silencio). Banco de voces fijo en forma SoA, procesado en grupos de 'groupSize' voces por sample de modo
+// que oscilador y envolvente se vectorizan a lo ancho de las voces.
+
+#pragma once
+
+#include <juce_audio_basics/juce_audio_basics.h>
+#include <array>
+#include <cmath>
+#include <limits>
+
+namespace cc
+{
+    class PreviewSynth
+    {
+    public:
+        static constexpr int groupSize = 8;                    // voces por registro (AVX: 8 floats)
+        static constexpr int numGroups = 4;
+        static constexpr int maxVoices = groupSize * numGroups;
+
+        void prepare(double newSampleRate);
+        void reset();
+
+        // Suma a 'buffer' (canales 0 y 1) las notas de 'midi', cada una en su sample. gain en [0, 1],
+        // en rampa desde el bloque anterior. Sin asignaciones: apto para el hilo de audio.
+        void render(juce::AudioBuffer<float>& buffer, const juce::MidiBuffer& midi, float gain);
+
+        int getNumActiveVoices() const;
+
+    private:
+        void noteOn(int channel, int note, int velocity);
+        void noteOff(int channel, int note);
+        void allNotesOff(int channel);
+        void renderSegment(float* left, float* right, int start, int numSamples);
+
+        // Envolvente de un polo: env += (target - env) * coeff. Ataque y release solo cambian target/coeff.
+        static constexpr float attackMs = 4.0f;
+        static constexpr float releaseMs = 60.0f;   // constante de tiempo: -80 dB en ~0.5 s
+        static constexpr float silence = 1.0e-4f;  // por debajo, una voz liberada queda libre
+
+        double sampleRate = 44100.0;
+        float attackCoeff = 0.0f, releaseCoeff = 0.0f;
+        float lastGain = -1.0f;  // < 0: sin bloque anterior, la primera rampa empieza en el valor actual
+
+        // Estado por voz (SoA, alineado para cargas vectoriales). La fase es un acumulador de 32 bits que
+        // da la vuelta solo: sin comparaciones en el bucle y, leída con signo, ya es x en [-1, 1).
+        alignas(32) std::array<juce::uint32, maxVoices> phase {};
+        alignas(32) std::array<juce::uint32, maxVoices> increment {};
+        alignas(32) std::array<float, maxVoices> env {};
+        alignas(32) std::array<float, maxVoices> target {};
+        alignas(32) std::array<float, maxVoices> coeff {};
+        alignas(32) std::array<float, maxVoices> panLeft {};
+        alignas(32) std::array<float, maxVoices> panRight {};
+
+        // Asignación (solo en eventos, fuera del bucle por sample)
+        std::array<juce::int16, maxVoices> voiceNote {};    // -1 = libre
+        std::array<juce::int8, maxVoices> voiceChannel {};
+        std::array<bool, maxVoices> released {};
+        std::array<juce::uint32, maxVoices> startedAt {};   // orden de disparo para robar la voz más antigua
+        juce::uint32 noteCounter = 0;
+        int activeGroups = 0;                               // grupos con alguna voz sonando
+    };
+}
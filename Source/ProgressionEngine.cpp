@@ -4,19 +4,6 @@
 
 namespace cc
 {
-    static std::vector<int> presetDegrees(ProgressionPreset preset)
-    {
-        switch (preset)
-        {
-            case ProgressionPreset::I_V_vi_IV: return {1,5,6,4};
-            case ProgressionPreset::ii_V_I:    return {2,5,1};
-            case ProgressionPreset::I_vi_IV_V: return {1,6,4,5};
-            case ProgressionPreset::vi_IV_I_V: return {6,4,1,5};
-            case ProgressionPreset::Custom:    return {}; // se ignora aquí
-            default:                           return {1,5,6,4};
-        }
-    }
-
     static float loadParam(const juce::AudioProcessorValueTreeState& apvts, const juce::String& id)
     {
         if (auto* p = apvts.getRawParameterValue(id))
@@ -29,171 +16,289 @@ namespace cc
         return (int) std::lrintf(loadParam(apvts, id));
     }
 
-    static bool loadBoolParam(const juce::AudioProcessorValueTreeState& apvts, const juce::String& id)
+    ProgressionEngine::~ProgressionEngine()
     {
-        return loadParam(apvts, id) >= 0.5f;
+        delete pendingQueue.exchange(nullptr);
+        for (auto& slot : retiredQueues)
+            delete slot.exchange(nullptr);
     }
 
-    void ProgressionEngine::buildQueueFromParameters(const juce::AudioProcessorValueTreeState& apvts)
+    void ProgressionEngine::buildQueueFromPlan(const ProgressionPlan& plan,
+                                               const juce::AudioProcessorValueTreeState& apvts,
+                                               double bpmIfKnown,
+                                               int lookAheadSamples)
     {
+        // Contenedor: el que devolvió el audio o, si aún no hay ninguno, uno nuevo con capacidad para la
+        // progresión más larga
+        std::unique_ptr<ProgressionQueue> next;
+        for (auto& slot : retiredQueues)
+        {
+            std::unique_ptr<ProgressionQueue> retired(slot.exchange(nullptr));
+            if (next == nullptr)
+                next = std::move(retired);
+        }
+        if (next == nullptr)
+        {
+            next = std::make_unique<ProgressionQueue>();
+            next->lanes.reserve(0, (size_t) ProgressionPlan::maxSteps * ((size_t) maxPatternNotes * 2 + (size_t) maxCcPerChord));
+            for (int lane = 1; lane < LaneQueues::maxLanes; ++lane)
+                next->lanes.reserve(lane, (size_t) maxLaneChords * ChordNotes::maxNotes * 2);
+        }
+
+        auto& queue = next->lanes;
         queue.clear();
-        nextIndex = 0;
-        currentSampleCursor = 0;
+        next->samplesPerQN = sampleRate * 60.0 / juce::jmax(1.0, bpmIfKnown);
+        lookAheadSamples = juce::jmax(0, lookAheadSamples);
+
+        // Con semilla fija cada build produce exactamente la misma cola (renders comparables)
+        if (const auto seed = randomSeed.load(std::memory_order_relaxed); seed != 0)
+            rng.setSeed(seed);
+
+        // Grados y acordes: del plan memoizado (o recalculados si un cambio aún no se ha publicado)
+        const PlanInputs live = readPlanInputs(apvts);
+        const int* degrees = nullptr;
+        const int numSteps = plan.resolveDegrees(live, degrees);
+        ChordNotes scratch;
 
-        const int keyIdx     = loadIntParam(apvts, ParamID::key);
-        const int scaleIdx   = loadIntParam(apvts, ParamID::scale);
-        const int presetIdx  = loadIntParam(apvts, ParamID::progressionPreset);
-        const juce::String customStr = apvts.state.getProperty(ParamID::progressionCustom, juce::String("1-5-6-4")).toString();
-        const int qualityIdx = loadIntParam(apvts, ParamID::chordQuality);
-
-        const bool add7  = loadBoolParam(apvts, ParamID::add7);
-        const bool add9  = loadBoolParam(apvts, ParamID::add9);
-        const bool add11 = loadBoolParam(apvts, ParamID::add11);
-        const bool add13 = loadBoolParam(apvts, ParamID::add13);
-        const int inversion    = loadIntParam(apvts, ParamID::inversion);
         const int velocity     = loadIntParam(apvts, ParamID::velocity);
         const int noteLengthMs = loadIntParam(apvts, ParamID::noteLengthMs);
         const int humanizeMs   = loadIntParam(apvts, ParamID::humanizeMs);
         const int humanizeVel  = loadIntParam(apvts, ParamID::humanizeVel);
-        const int octave       = loadIntParam(apvts, ParamID::octave);
+        const auto pattern     = (PatternMode) loadIntParam(apvts, ParamID::pattern);
+        const auto patternRate = (PatternRate) loadIntParam(apvts, ParamID::patternRate);
+        const int strumMs      = loadIntParam(apvts, ParamID::strumMs);
+        const int ratchet      = loadIntParam(apvts, ParamID::ratchet);
+        const auto ccShape     = (CcShape) loadIntParam(apvts, ParamID::ccShape);
+        const int ccNumber     = loadIntParam(apvts, ParamID::ccNumber);
+        const bool legato      = loadIntParam(apvts, ParamID::legato) != 0;
+
+        CcLane ccLane;
+        const CcThinning thinning { loadIntParam(apvts, ParamID::ccThreshold), cc::msToSamples(sampleRate, CcLane::minIntervalMs) };
+        auto& mainEvents = queue.events(0);
+        auto addCc = [&mainEvents](juce::int64 t, int channel, int controller, int value)
+        {
+            mainEvents.push_back(TimedEvent { (int) t, juce::MidiMessage::controllerEvent(channel, controller, value) });
+        };
+
+        // Núcleo de emisión especializado: la cola entera usa los mismos rasgos
+        ChordEmitParams params;
+        params.length          = cc::msToSamples(sampleRate, noteLengthMs);
+        params.step            = (juce::int64) std::round(patternRateToQuarterNotes(patternRate) * 60.0 / juce::jmax(1.0, bpmIfKnown) * sampleRate);
+        params.strum           = cc::msToSamples(sampleRate, strumMs);
+        params.ratchet         = ratchet;
+        params.pattern         = pattern;
+        params.velocity        = velocity;
+        params.humanizeSamples = cc::msToSamples(sampleRate, humanizeMs);
+        params.humanizeVel     = humanizeVel;
+
+        ChordEmitFlags flags;
+        flags.humanize   = humanizeMs > 0 || humanizeVel > 0;
+        flags.extensions = chordHasExtensions((ChordQuality) live.quality, live.toggles);
+        flags.patterned  = pattern != PatternMode::Block;
+        const auto emit = selectChordEmitter<QueueSink>(flags);
+
+        ChordEmitScratch emitScratch { patternScratch, humanizeScratch, rng };
+        QueueSink sink { mainEvents };
+
+        // Legato: solo con acordes en bloque sin ratchet (en arpegios no hay notas comunes simultáneas)
+        LegatoVoices legatoVoices;
+        const bool tie = legato && pattern == PatternMode::Block && ratchet <= 1;
+        auto release = [&sink](juce::int64 time, int note) { sink.release(time, note); };
+        sink.legato = tie ? &legatoVoices : nullptr;
+
+        // Usa canal 2 para eventos generados por el motor, para diferenciarlos de NoteOn entrantes del host
+        juce::int64 timeCursor = 0;
+        for (int step = 0; step < numSteps; ++step)
+        {
+            const ChordNotes& chord = plan.resolveChord(live, degrees, step, scratch);
+            params.start = lookAheadSamples + timeCursor;
+            if (tie)
+                legatoVoices.beginChord(params.start, params.humanizeSamples, release);
+            const int emitted = emit(params, chord, emitScratch, sink);
+            if (tie)
+                legatoVoices.endChord(emitted > 0);
+
+            // Curva de CC del acorde, ya aclarada: se inyecta como cualquier otro evento de la cola
+            ccLane.start(params.start, params.length, ccShape, 2, ccNumber);
+            ccLane.render(params.start, (int) params.length + 1, thinning, maxCcPerChord, addCc);
+
+            timeCursor += params.length;
+        }
 
-        std::vector<int> degrees;
-        if ((ProgressionPreset) presetIdx == ProgressionPreset::Custom)
-            degrees = cc::parseProgressionString(customStr);
-        else
-            degrees = presetDegrees((ProgressionPreset) presetIdx);
+        if (tie)
+            legatoVoices.releaseAll(release);
 
-        if (degrees.empty())
-            degrees = {1, 5, 6, 4};
+        queue.finish(0);
 
-        const auto scale      = (ScaleType) scaleIdx;
-        const auto quality    = (ChordQuality) qualityIdx;
-        const int keySemitone = keyIdx; // 0..11
+        // Carriles extra: misma duración total que la principal, cada uno en su canal y a su ritmo
+        const auto laneSettings = readLaneSettings(apvts);
+        for (int lane = 1; lane < LaneQueues::maxLanes; ++lane)
+        {
+            if (! laneSettings.enabled[(size_t) lane])
+                continue;
+            buildLaneEvents(laneSettings, lane, live, degrees, numSteps, lookAheadSamples, timeCursor,
+                            next->samplesPerQN, velocity, queue.events(lane));
+            queue.finish(lane);
+        }
 
-        const int chordLenSamples = cc::msToSamples(sampleRate, noteLengthMs);
+        // Publicación. Una cola anterior que el audio no llegó a recoger se libera aquí.
+        std::unique_ptr<ProgressionQueue> unused(pendingQueue.exchange(next.release()));
+    }
 
-        int timeCursor = 0;
-        for (int deg : degrees)
+    void ProgressionEngine::startPlayback(const TransportPosition& transport)
+    {
+        if (auto* next = pendingQueue.exchange(nullptr))
         {
-            const int root = degreeToMidi(deg, keySemitone, scale, octave);
-            const ExtensionToggles togg { add7, add9, add11, add13 };
-            auto notes = makeChordNotes(root, scale, quality, inversion, togg);
+            std::swap(lanes, next->lanes);
+            samplesPerQN = next->samplesPerQN;
 
-            for (int n : notes)
+            // Entre dos builds el audio devuelve como mucho dos contenedores (el pendiente del build
+            // anterior y el del último) y cada build vacía los dos huecos: siempre hay uno libre
+            bool returned = false;
+            for (auto& slot : retiredQueues)
             {
-                const int vel = cc::humanizeVelocity(velocity, humanizeVel, rng);
-                const int hOn = cc::humanizeMsToSamples(sampleRate, humanizeMs, rng);
-                const int hOff = cc::humanizeMsToSamples(sampleRate, humanizeMs, rng);
-
-                // Usa canal 2 para eventos generados por el motor,
-                // para diferenciarlos de NoteOn entrantes del host
-                juce::MidiMessage on = juce::MidiMessage::noteOn(2, n, (juce::uint8) vel);
-                juce::MidiMessage off = juce::MidiMessage::noteOff(2, n);
-
-                const int onPos  = std::max(0, timeCursor + hOn);
-                const int offPos = std::max(0, timeCursor + chordLenSamples + hOff);
-                queue.push_back(TimedEvent { onPos, on });
-                queue.push_back(TimedEvent { offPos, off });
+                ProgressionQueue* empty = nullptr;
+                if (slot.compare_exchange_strong(empty, next))
+                {
+                    returned = true;
+                    break;
+                }
             }
-
-            timeCursor += chordLenSamples;
+            jassert(returned);
+            juce::ignoreUnused(returned);
         }
 
-        // Ordenar por sampleOffset
-        std::sort(queue.begin(), queue.end(), [](const TimedEvent& a, const TimedEvent& b){ return a.sampleOffset < b.sampleOffset; });
+        lanes.rewind();
+        currentSampleCursor = 0;
+
+        // Anclaje a la línea de tiempo del host: la cola empieza en el PPQ del bloque actual
+        anchored = transport.playing && transport.hasPpq;
+        anchorPpq = transport.ppq;
+        expectedPpq = transport.ppq;
+        transportWasPlaying = anchored;
+        playing = true;
     }
 
-    void ProgressionEngine::injectQueuedEvents(juce::MidiBuffer& midiOut, int numSamples)
+    void ProgressionEngine::injectQueuedEvents(BlockEventList& out, int numSamples, const TransportPosition& transport)
     {
-        if (!playing || queue.empty())
+        if (playing && anchored && transport.hasPpq)
+        {
+            if (! transport.playing)
+            {
+                // Transporte parado: la cola se pausa en su posición y deja de sonar
+                if (transportWasPlaying)
+                    releaseSounding(out);
+                transportWasPlaying = false;
+                return;
+            }
+
+            // Arranque del transporte o salto del cursor (loop, clic en la regla): reubicar
+            if (! transportWasPlaying || std::abs(transport.ppq - expectedPpq) > jumpToleranceQN)
+                seek(out, (juce::int64) std::llround((transport.ppq - anchorPpq) * samplesPerQN));
+
+            transportWasPlaying = true;
+            expectedPpq = transport.ppq + numSamples * juce::jmax(1.0, transport.bpm) / (60.0 * sampleRate);
+        }
+
+        if (!playing || lanes.empty())
         {
             currentSampleCursor += numSamples;
             return;
         }
 
-        const int blockStart = currentSampleCursor;
-        const int blockEnd   = currentSampleCursor + numSamples;
+        // Merge k-way de los carriles: solo se tocan las cabezas con eventos dentro del bloque
+        lanes.merge(currentSampleCursor, currentSampleCursor + numSamples,
+                    [this, &out](int posInBlock, const TimedEvent& ev) { emit(out, posInBlock, ev); });
+
+        currentSampleCursor += numSamples;
+
+        // Cola agotada. Anclada sigue armada: un loop del host puede volver a entrar en ella
+        if (lanes.exhausted() && ! anchored)
+            playing = false;
+    }
+
+    void ProgressionEngine::emit(BlockEventList& out, int samplePosition, const TimedEvent& ev)
+    {
+        auto& count = sounding[(size_t) ((ev.msg.getChannel() - 1) * 128 + ev.msg.getNoteNumber())];
+        if (ev.msg.isNoteOn())
+            ++count;
+        else if (ev.msg.isNoteOff() && count > 0)
+            --count;
+        out.add(samplePosition, ev.msg);
+    }
+
+    void ProgressionEngine::seek(BlockEventList& out, juce::int64 cursor)
+    {
+        releaseSounding(out);
+
+        const auto clamped = (int) juce::jlimit((juce::int64) std::numeric_limits<int>::min() / 2,
+                                                (juce::int64) std::numeric_limits<int>::max() / 2, cursor);
+        currentSampleCursor = clamped;
+
+        // Primer evento en o después del cursor en cada carril (O(log n)) y re-ataque de lo que sigue sonando
+        lanes.seek(clamped, [this, &out](const TimedEvent& ev) { emit(out, 0, ev); });
+    }
 
-        while (nextIndex < queue.size())
+    void ProgressionEngine::releaseSounding(BlockEventList& out)
+    {
+        for (int i = 0; i < (int) sounding.size(); ++i)
         {
-            const auto& ev = queue[nextIndex];
-            if (ev.sampleOffset >= blockStart && ev.sampleOffset < blockEnd)
-            {
-                const int posInBlock = ev.sampleOffset - blockStart;
-                midiOut.addEvent(ev.msg, posInBlock);
-                ++nextIndex;
-            }
-            else if (ev.sampleOffset >= blockEnd)
-            {
-                break; // pendiente para próximos bloques
-            }
-            else
-            {
-                // Evento anterior al bloque actual: si es el primer bloque, clampa a 0
-                if (blockStart == 0 && ev.sampleOffset < 0)
-                {
-                    midiOut.addEvent(ev.msg, 0);
-                }
-                ++nextIndex;
-            }
+            if (sounding[(size_t) i] > 0)
+                out.add(0, juce::MidiMessage::noteOff(i / 128 + 1, i % 128));
         }
+        sounding.fill(0);
+    }
 
-        currentSampleCursor += numSamples;
-        if (nextIndex >= queue.size())
-            playing = false; // cola agotada
+    void ProgressionEngine::stopPlayback(BlockEventList& out)
+    {
+        releaseSounding(out);
+        playing = false;
+        anchored = false;
     }
 
-    bool ProgressionEngine::exportProgressionToMidiFile(const juce::AudioProcessorValueTreeState& apvts,
+    bool ProgressionEngine::exportProgressionToMidiFile(const ProgressionPlan& plan,
+                                                        const juce::AudioProcessorValueTreeState& apvts,
                                                         const juce::File& dest,
                                                         double bpmIfKnown) const
     {
-        const int keyIdx     = loadIntParam(apvts, ParamID::key);
-        const int scaleIdx   = loadIntParam(apvts, ParamID::scale);
-        const int presetIdx  = loadIntParam(apvts, ParamID::progressionPreset);
-        const juce::String customStr = apvts.state.getProperty(ParamID::progressionCustom, juce::String("1-5-6-4")).toString();
-        const int qualityIdx = loadIntParam(apvts, ParamID::chordQuality);
-
-        const bool add7  = loadBoolParam(apvts, ParamID::add7);
-        const bool add9  = loadBoolParam(apvts, ParamID::add9);
-        const bool add11 = loadBoolParam(apvts, ParamID::add11);
-        const bool add13 = loadBoolParam(apvts, ParamID::add13);
-        const int inversion    = loadIntParam(apvts, ParamID::inversion);
+        // Grados y acordes: del plan memoizado (o recalculados si un cambio aún no se ha publicado)
+        const PlanInputs live = readPlanInputs(apvts);
+        const int* degrees = nullptr;
+        const int numSteps = plan.resolveDegrees(live, degrees);
+        ChordNotes scratch;
+
         const int velocity     = loadIntParam(apvts, ParamID::velocity);
         const int noteLengthMs = loadIntParam(apvts, ParamID::noteLengthMs);
-        const int octave       = loadIntParam(apvts, ParamID::octave);
-
-        std::vector<int> degrees;
-        if ((ProgressionPreset) presetIdx == ProgressionPreset::Custom)
-            degrees = cc::parseProgressionString(customStr);
-        else
-            degrees = presetDegrees((ProgressionPreset) presetIdx);
-
-        if (degrees.empty())
-            degrees = {1, 5, 6, 4};
-
-        const auto scale      = (ScaleType) scaleIdx;
-        const auto quality    = (ChordQuality) qualityIdx;
-        const int keySemitone = keyIdx; // 0..11
+        const auto pattern     = (PatternMode) loadIntParam(apvts, ParamID::pattern);
+        const auto patternRate = (PatternRate) loadIntParam(apvts, ParamID::patternRate);
+        const int strumMs      = loadIntParam(apvts, ParamID::strumMs);
+        const int ratchet      = loadIntParam(apvts, ParamID::ratchet);
 
         const double qnMs = 60000.0 / juce::jmax(1.0, bpmIfKnown);
         const double chordLenQN = static_cast<double>(noteLengthMs) / qnMs; // cuántas negras dura
         const int ticksPerQN = 960;
         const int chordLenTicks = (int) std::round(chordLenQN * ticksPerQN);
 
+        const int stepTicks  = (int) std::round(patternRateToQuarterNotes(patternRate) * ticksPerQN);
+        const int strumTicks = (int) std::round(static_cast<double>(strumMs) / qnMs * ticksPerQN);
+
         juce::MidiMessageSequence seq;
+        PatternNotes expanded;
         int tickCursor = 0;
-        for (int deg : degrees)
+        for (int step = 0; step < numSteps; ++step)
         {
-            const int root = degreeToMidi(deg, keySemitone, scale, octave);
-            const ExtensionToggles togg { add7, add9, add11, add13 };
-            auto notes = makeChordNotes(root, scale, quality, inversion, togg);
+            const ChordNotes& chord = plan.resolveChord(live, degrees, step, scratch);
+
+            const PatternTiming timing { tickCursor, chordLenTicks, stepTicks, strumTicks, ratchet };
+            const int numNotes = expandPattern(pattern, chord, timing, expanded);
 
-            for (int n : notes)
+            for (int i = 0; i < numNotes; ++i)
             {
-                juce::MidiMessage on = juce::MidiMessage::noteOn(1, n, (juce::uint8) velocity);
-                juce::MidiMessage off = juce::MidiMessage::noteOff(1, n);
-                on.setTimeStamp(tickCursor);
-                off.setTimeStamp(tickCursor + chordLenTicks);
+                const auto& pn = expanded[(size_t) i];
+                juce::MidiMessage on = juce::MidiMessage::noteOn(1, pn.note, (juce::uint8) velocity);
+                juce::MidiMessage off = juce::MidiMessage::noteOff(1, pn.note);
+                on.setTimeStamp((double) pn.on);
+                off.setTimeStamp((double) pn.off);
                 seq.addEvent(on);
                 seq.addEvent(off);
             }
@@ -5,16 +5,42 @@
 
 #include <juce_audio_basics/juce_audio_basics.h>
 #include <juce_audio_processors/juce_audio_processors.h>
+#include <atomic>
 #include "Parameters.h"
 #include "Theory.h"
+#include "Patterns.h"
+#include "FastRandom.h"
+#include "ChordEmitter.h"
+#include "BlockEventList.h"
+#include "ProgressionPlan.h"
+#include "CcLane.h"
+#include "LegatoVoices.h"
+#include "ProgressionLanes.h"
 #include "Utils.h"
 
 namespace cc
 {
+    // Posición del host al principio del bloque (sin PPQ la cola avanza libre en samples)
+    struct TransportPosition
+    {
+        bool playing = false;
+        bool hasPpq = false;
+        double ppq = 0.0;
+        double bpm = 120.0;
+    };
+
+    // Cola construida fuera del hilo de audio, lista para sustituir a la que suena
+    struct ProgressionQueue
+    {
+        LaneQueues lanes;
+        double samplesPerQN = 22050.0;
+    };
+
     class ProgressionEngine
     {
     public:
         ProgressionEngine() = default;
+        ~ProgressionEngine();
 
         void prepare(double newSampleRate)
         {
@@ -25,38 +51,113 @@ namespace cc
         void resetPlayback()
         {
             currentSampleCursor = 0;
-            nextIndex = 0;
+            lanes.rewind();
             playing = false;
+            anchored = false;
+            transportWasPlaying = false;
+            sounding.fill(0);
         }
 
-        // Construye la progresión en la cola interna
-        void buildQueueFromParameters(const juce::AudioProcessorValueTreeState& apvts);
+        // Hilo de mensajes. Construye la progresión del plan en una cola nueva y la deja pendiente para el
+        // siguiente startPlayback; timing, patrón y humanización se leen de los parámetros (bpm define la
+        // duración de los pasos de arpegio). Los carriles extra activos repiten su propia progresión a su
+        // ritmo durante lo que dura la principal. Con look-ahead la cola se desplaza 'lookAheadSamples',
+        // de modo que la humanización puede adelantar notas sin recortarse a 0.
+        void buildQueueFromPlan(const ProgressionPlan& plan,
+                                const juce::AudioProcessorValueTreeState& apvts,
+                                double bpmIfKnown = 120.0,
+                                int lookAheadSamples = 0);
 
-        // Comienza reproducción de la cola (se inyecta en processBlock)
-        void startPlayback() { playing = true; }
-        void stopPlayback()  { playing = false; }
+        // Hilo de audio. Sustituye la cola por la pendiente (intercambio de punteros, sin copias ni
+        // asignaciones) y comienza a reproducirla. Con el transporte en marcha la cola queda anclada a la
+        // línea de tiempo del host en 'transport.ppq': los saltos del cursor (loops, clics en la regla) se
+        // resuelven con seek. Sin cola pendiente vuelve a empezar la actual.
+        void startPlayback(const TransportPosition& transport = {});
+
+        // Detiene la cola y añade en 'out' (posición 0) los note-off de las notas que siguen sonando
+        void stopPlayback(BlockEventList& out);
         bool isPlaying() const { return playing; }
 
-        // Avanza el cursor y añade eventos que caen dentro del bloque
-        void injectQueuedEvents(juce::MidiBuffer& midiOut, int numSamples);
+        // Semilla de humanización: 0 = no reproducible; otro valor = misma cola en cada build.
+        // Se puede fijar desde cualquier hilo: la lee el build en el hilo de mensajes.
+        void setRandomSeed(juce::uint64 newSeed) { randomSeed.store(newSeed, std::memory_order_relaxed); }
+
+        // Avanza el cursor y añade eventos que caen dentro del bloque. Con la cola anclada, un salto del
+        // PPQ del host (o el arranque del transporte) reubica el cursor antes de emitir.
+        void injectQueuedEvents(BlockEventList& out, int numSamples, const TransportPosition& transport = {});
 
         // Exporta progresión actual a archivo MIDI (.mid)
-        bool exportProgressionToMidiFile(const juce::AudioProcessorValueTreeState& apvts,
+        bool exportProgressionToMidiFile(const ProgressionPlan& plan,
+                                         const juce::AudioProcessorValueTreeState& apvts,
                                          const juce::File& dest,
                                          double bpmIfKnown = 120.0) const;
 
     private:
-        struct TimedEvent
+        // Destino de los núcleos de emisión: note-on/off en canal 2.
+        // En legato los note-off llegan después por release(), cuando se conoce el final de cada nota ligada.
+        struct QueueSink
         {
-            int sampleOffset = 0; // desde inicio de cola
-            juce::MidiMessage msg;
+            std::vector<TimedEvent>& queue;
+            LegatoVoices* legato = nullptr;
+            std::array<int, 128> heldOnIndex {};  // legato: note-on de la nota retenida (para fijar su endOffset)
+
+            bool reserve(int) { return true; }
+            void note(juce::int64 on, juce::int64 off, int note, int velocity)
+            {
+                if (legato != nullptr)
+                {
+                    if (legato->noteOn(note, off))
+                    {
+                        heldOnIndex[(size_t) note] = (int) queue.size();
+                        queue.push_back(TimedEvent { (int) on, juce::MidiMessage::noteOn(2, note, (juce::uint8) velocity), (int) off });
+                    }
+                    return;
+                }
+                queue.push_back(TimedEvent { (int) on, juce::MidiMessage::noteOn(2, note, (juce::uint8) velocity), (int) off });
+                queue.push_back(TimedEvent { (int) off, juce::MidiMessage::noteOff(2, note) });
+            }
+
+            void release(juce::int64 time, int note)
+            {
+                queue.push_back(TimedEvent { (int) time, juce::MidiMessage::noteOff(2, note) });
+                queue[(size_t) heldOnIndex[(size_t) note]].endOffset = (int) time;
+            }
         };
 
-        std::vector<TimedEvent> queue;
-        size_t nextIndex = 0;
+        // CC por acorde en la cola (curva aclarada; acota también la memoria reservada)
+        static constexpr int maxCcPerChord = 256;
+
+        // Saltos del PPQ menores que esto se consideran deriva (rampas de tempo), no reubicación
+        static constexpr double jumpToleranceQN = 1.0 / 64.0;
+
+        // Reubica el cursor (búsqueda binaria), apaga lo que suena y re-ataca lo que debería sonar en 'cursor'
+        void seek(BlockEventList& out, juce::int64 cursor);
+        void releaseSounding(BlockEventList& out);
+        void emit(BlockEventList& out, int samplePosition, const TimedEvent& ev);
+
+        LaneQueues lanes;            // carril 0 = progresión principal (canal 2), después los extra
         bool playing = false;
         double sampleRate = 44100.0;
         int currentSampleCursor = 0; // acumulado desde inicio
-        juce::Random rng;
+
+        // Línea de tiempo: la muestra 0 de la cola corresponde a 'anchorPpq' del host
+        bool anchored = false;
+        double anchorPpq = 0.0;
+        double samplesPerQN = 22050.0;
+        double expectedPpq = 0.0;      // PPQ esperado al principio del siguiente bloque
+        bool transportWasPlaying = false;
+        std::array<juce::uint8, 16 * 128> sounding {}; // notas de la cola encendidas, por canal
+
+        // Relevo de colas: el build deja la nueva en 'pendingQueue'; el audio la intercambia con la suya y
+        // devuelve el contenedor (con la cola anterior) en 'retiredQueues', que el build reutiliza. Así las
+        // asignaciones y liberaciones ocurren siempre en el hilo de mensajes.
+        std::atomic<ProgressionQueue*> pendingQueue { nullptr };
+        std::array<std::atomic<ProgressionQueue*>, 2> retiredQueues {};
+
+        // Solo build (hilo de mensajes)
+        FastRandom rng;
+        std::atomic<juce::uint64> randomSeed { 0 };
+        PatternNotes patternScratch;   // expansión del acorde actual (reutilizada)
+        HumanizeBatch humanizeScratch; // humanización del acorde actual (reutilizada)
     };
 }
\ No newline at end of file
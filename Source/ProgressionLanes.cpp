@@ -0,0 +1,129 @@
+// ProgressionLanes.cpp
+
+#include "ProgressionLanes.h"
+
+namespace cc
+{
+    namespace
+    {
+        int loadLaneParam(const juce::AudioProcessorValueTreeState& apvts, const char* id)
+        {
+            if (auto* p = apvts.getRawParameterValue(id))
+                return (int) std::lrintf(p->load());
+            return 0;
+        }
+    }
+
+    LaneSettings readLaneSettings(const juce::AudioProcessorValueTreeState& apvts)
+    {
+        LaneSettings s;
+        s.enabled[0] = true;
+        s.channel[0] = 2;
+
+        for (int extra = 0; extra < numExtraLanes; ++extra)
+        {
+            const auto lane = (size_t) extra + 1;
+            s.enabled[lane]     = loadLaneParam(apvts, LaneParamID::enabled[extra]) != 0;
+            s.progression[lane] = loadLaneParam(apvts, LaneParamID::progression[extra]);
+            s.lengthQN[lane]    = laneRateToQuarterNotes((LaneRate) loadLaneParam(apvts, LaneParamID::rate[extra]));
+            s.gatePercent[lane] = loadLaneParam(apvts, LaneParamID::gate[extra]);
+            s.channel[lane]     = juce::jlimit(1, 16, loadLaneParam(apvts, LaneParamID::channel[extra]));
+            s.octaveShift[lane] = loadLaneParam(apvts, LaneParamID::octave[extra]);
+            s.voicing[lane]     = (LaneVoicing) loadLaneParam(apvts, LaneParamID::voicing[extra]);
+        }
+        return s;
+    }
+
+    void buildLaneEvents(const LaneSettings& settings, int lane, const PlanInputs& live,
+                         const int* mainDegrees, int mainSteps, juce::int64 start, juce::int64 duration,
+                         double samplesPerQN, int velocity, std::vector<TimedEvent>& out)
+    {
+        const auto l = (size_t) lane;
+
+        // Grados propios (preset) o los del carril principal
+        int numDegrees = mainSteps;
+        const int* degrees = mainDegrees;
+        if (settings.progression[l] > 0)
+            degrees = getPresetDegrees((ProgressionPreset) (settings.progression[l] - 1), numDegrees);
+        if (degrees == nullptr || numDegrees <= 0)
+            return;
+
+        const auto scale = (ScaleType) live.scale;
+        const int shift = settings.octaveShift[l] * 12;
+
+        // Un acorde por grado (1..7), ya desplazado de octava; makeChordNotes ajusta el rango antes
+        std::array<ChordNotes, 8> chords {};
+        for (int d = 1; d <= 7; ++d)
+        {
+            auto& chord = chords[(size_t) d];
+            const int root = degreeToMidi(d, live.key, scale, live.octave);
+            if (settings.voicing[l] == LaneVoicing::Root)
+            {
+                chord.notes[0] = root;
+                chord.size = 1;
+            }
+            else
+            {
+                makeChordNotes(root, scale, (ChordQuality) live.quality, live.inversion, live.toggles, chord);
+            }
+            for (int i = 0; i < chord.size; ++i)
+                chord.notes[(size_t) i] = juce::jlimit(0, 127, chord.notes[(size_t) i] + shift);
+        }
+
+        const auto chordSamples = juce::jmax((juce::int64) 1, (juce::int64) std::llround(settings.lengthQN[l] * samplesPerQN));
+        const auto gateSamples  = juce::jmax((juce::int64) 1, chordSamples * settings.gatePercent[l] / 100);
+        const int channel = settings.channel[l];
+        const juce::int64 end = start + duration;
+
+        int step = 0;
+        for (juce::int64 t = start; t < end && step < maxLaneChords; t += chordSamples, ++step)
+        {
+            const int degree = juce::jlimit(1, 7, degrees[step % numDegrees]);
+            const auto off = juce::jmin(t + gateSamples, end);
+            for (const int note : chords[(size_t) degree])
+            {
+                out.push_back(TimedEvent { (int) t, juce::MidiMessage::noteOn(channel, note, (juce::uint8) velocity), (int) off });
+                out.push_back(TimedEvent { (int) off, juce::MidiMessage::noteOff(channel, note) });
+            }
+        }
+    }
+
+    //==============================================================================
+    void LaneQueues::clear()
+    {
+        for (auto& q : queues)
+            q.clear();
+        cursors.fill(0);
+        maxNoteSamples.fill(0);
+    }
+
+    void LaneQueues::finish(int lane)
+    {
+        auto& q = queues[(size_t) lane];
+        std::sort(q.begin(), q.end(), [](const TimedEvent& a, const TimedEvent& b)
+        {
+            if (a.sampleOffset != b.sampleOffset)
+                return a.sampleOffset < b.sampleOffset;
+            return eventRank(a.msg) < eventRank(b.msg);
+        });
+
+        int longest = 0;
+        for (const auto& ev : q)
+            if (ev.msg.isNoteOn())
+                longest = juce::jmax(longest, ev.endOffset - ev.sampleOffset);
+        maxNoteSamples[(size_t) lane] = longest;
+    }
+
+    bool LaneQueues::empty() const
+    {
+        return std::all_of(queues.begin(), queues.end(), [](const std::vector<TimedEvent>& q) { return q.empty(); });
+    }
+
+    bool LaneQueues::exhausted() const
+    {
+        for (size_t lane = 0; lane < queues.size(); ++lane)
+            if (cursors[lane] < queues[lane].size())
+                return false;
+        return true;
+    }
+}
@@ -0,0 +1,161 @@
+// ProgressionLanes.h
+// Carriles de progresión independientes (bajo, pad, stabs...) en forma de estructura de arrays y su mezcla
+// por bloque: merge k-way sobre un heap de las cabezas de cada carril
+
+#pragma once
+
+#include <juce_audio_basics/juce_audio_basics.h>
+#include <juce_audio_processors/juce_audio_processors.h>
+#include <algorithm>
+#include <array>
+#include <vector>
+#include "Parameters.h"
+#include "Theory.h"
+#include "ProgressionPlan.h"
+
+namespace cc
+{
+    struct TimedEvent
+    {
+        int sampleOffset = 0; // desde inicio de cola
+        juce::MidiMessage msg;
+        int endOffset = 0;    // note-on: sample de su note-off (para saber qué suena tras un seek)
+    };
+
+    // Orden dentro del mismo sample: note-offs, CC y después note-ons
+    inline int eventRank(const juce::MidiMessage& m)
+    {
+        return m.isNoteOff() ? 0 : (m.isController() ? 1 : 2);
+    }
+
+    // Ajustes de los carriles, un array por campo. El carril 0 es la progresión principal (canal 2);
+    // de él solo se usan 'enabled' y 'channel'.
+    struct LaneSettings
+    {
+        static constexpr int maxLanes = 1 + numExtraLanes;
+
+        std::array<bool, maxLanes> enabled {};
+        std::array<int, maxLanes> progression {};    // índice de getLaneProgressionChoices (0 = la principal)
+        std::array<double, maxLanes> lengthQN {};    // duración de cada acorde en negras
+        std::array<int, maxLanes> gatePercent {};
+        std::array<int, maxLanes> channel {};
+        std::array<int, maxLanes> octaveShift {};
+        std::array<LaneVoicing, maxLanes> voicing {};
+    };
+
+    LaneSettings readLaneSettings(const juce::AudioProcessorValueTreeState& apvts);
+
+    // Acordes del carril 'lane' en bloque, repitiendo su progresión hasta cubrir [start, start + duration).
+    // Añade a 'out' sin ordenar; como mucho maxLaneChords acordes (la memoria se reserva en prepare).
+    static constexpr int maxLaneChords = 256;
+    void buildLaneEvents(const LaneSettings& settings, int lane, const PlanInputs& live,
+                         const int* mainDegrees, int mainSteps, juce::int64 start, juce::int64 duration,
+                         double samplesPerQN, int velocity, std::vector<TimedEvent>& out);
+
+    // Colas de eventos por carril con su cursor. Cada cola está ordenada; la salida del bloque es el merge
+    // de sus cabezas, de modo que el coste es O(carriles + eventos emitidos * log carriles).
+    class LaneQueues
+    {
+    public:
+        static constexpr int maxLanes = LaneSettings::maxLanes;
+
+        std::vector<TimedEvent>& events(int lane) { return queues[(size_t) lane]; }
+        void reserve(int lane, size_t numEvents) { queues[(size_t) lane].reserve(numEvents); }
+
+        void clear();
+        void rewind() { cursors.fill(0); }
+
+        // Ordena la cola del carril y mide su nota más larga (límite del escaneo hacia atrás en seek)
+        void finish(int lane);
+
+        bool empty() const;
+        bool exhausted() const;
+
+        // Emite en orden los eventos con sampleOffset en [blockStart, blockEnd): emit(posEnBloque, evento).
+        // Lo anterior al bloque se descarta, salvo en el primer bloque (offsets negativos se clampan a 0).
+        template <typename Emit>
+        void merge(int blockStart, int blockEnd, Emit&& emit)
+        {
+            std::array<Head, maxLanes> heap;
+            int size = 0;
+
+            for (int lane = 0; lane < maxLanes; ++lane)
+            {
+                const auto& q = queues[(size_t) lane];
+                auto& i = cursors[(size_t) lane];
+                for (; i < q.size() && q[i].sampleOffset < blockStart; ++i)
+                    if (blockStart == 0 && q[i].sampleOffset < 0)
+                        emit(0, q[i]);
+
+                if (i < q.size() && q[i].sampleOffset < blockEnd)
+                    heap[(size_t) size++] = headOf(lane);
+            }
+            std::make_heap(heap.begin(), heap.begin() + size, later);
+
+            while (size > 0)
+            {
+                std::pop_heap(heap.begin(), heap.begin() + size, later);
+                const int lane = heap[(size_t) --size].lane;
+                const auto& q = queues[(size_t) lane];
+                auto& i = cursors[(size_t) lane];
+                emit(q[i].sampleOffset - blockStart, q[i]);
+
+                if (++i < q.size() && q[i].sampleOffset < blockEnd)
+                {
+                    heap[(size_t) size++] = headOf(lane);
+                    std::push_heap(heap.begin(), heap.begin() + size, later);
+                }
+            }
+        }
+
+        // Reubica los cursores en 'cursor' (búsqueda binaria por carril) y llama a resound(evento) para cada
+        // note-on que empezó antes y sigue sonando en 'cursor'
+        template <typename Resound>
+        void seek(int cursor, Resound&& resound)
+        {
+            for (int lane = 0; lane < maxLanes; ++lane)
+            {
+                const auto& q = queues[(size_t) lane];
+                const auto first = std::lower_bound(q.begin(), q.end(), cursor,
+                                                    [](const TimedEvent& e, int c) { return e.sampleOffset < c; });
+                const auto index = (size_t) std::distance(q.begin(), first);
+                cursors[(size_t) lane] = index;
+
+                for (size_t i = index; i-- > 0;)
+                {
+                    const auto& ev = q[i];
+                    if (ev.sampleOffset < cursor - maxNoteSamples[(size_t) lane])
+                        break;
+                    if (ev.msg.isNoteOn() && ev.endOffset > cursor)
+                        resound(ev);
+                }
+            }
+        }
+
+    private:
+        struct Head
+        {
+            int time = 0;
+            int rank = 0;
+            int lane = 0;
+        };
+
+        // Comparador de std::*_heap: con 'later' el heap deja arriba el evento más temprano
+        static bool later(const Head& a, const Head& b)
+        {
+            if (a.time != b.time) return a.time > b.time;
+            if (a.rank != b.rank) return a.rank > b.rank;
+            return a.lane > b.lane;
+        }
+
+        Head headOf(int lane) const
+        {
+            const auto& ev = queues[(size_t) lane][cursors[(size_t) lane]];
+            return { ev.sampleOffset, eventRank(ev.msg), lane };
+        }
+
+        std::array<std::vector<TimedEvent>, maxLanes> queues;
+        std::array<size_t, maxLanes> cursors {};
+        std::array<int, maxLanes> maxNoteSamples {};
+    };
+}
@@ -0,0 +1,397 @@
+// ProgressionPlan.cpp
+
+#include "ProgressionPlan.h"
+
+namespace cc
+{
+    namespace
+    {
+        constexpr int degreesI_V_vi_IV[] = { 1, 5, 6, 4 };
+        constexpr int degreesii_V_I[]    = { 2, 5, 1 };
+        constexpr int degreesI_vi_IV_V[] = { 1, 6, 4, 5 };
+        constexpr int degreesvi_IV_I_V[] = { 6, 4, 1, 5 };
+
+        // Ids de los parámetros que alteran grados o acordes del plan
+        const char* const planParamIDs[] = {
+            ParamID::progressionPreset, ParamID::key, ParamID::scale, ParamID::chordQuality,
+            ParamID::add7, ParamID::add9, ParamID::add11, ParamID::add13, ParamID::inversion, ParamID::octave
+        };
+
+        int loadPlanParam(const juce::AudioProcessorValueTreeState& apvts, const char* id)
+        {
+            if (auto* p = apvts.getRawParameterValue(id))
+                return (int) std::lrintf(p->load());
+            return 0;
+        }
+
+        // Grado por clase de nota de la tecla (0 = tecla negra, sin acorde)
+        constexpr int whiteKeyDegrees[12] = { 1, 0, 2, 0, 3, 4, 0, 5, 0, 6, 0, 7 };
+
+        // Los acordes de tecla se construyen (y se ajustan a 48–84) en la octava del Do central y después
+        // se trasladan a la octava de la tecla: el ajuste de rango no debe deshacer el registro elegido
+        constexpr int keyReferenceOctave = 5;  // 60 / 12
+
+        int keyChordRoot(const PlanInputs& in, int degree)
+        {
+            return degreeToMidi(degree, in.key, (ScaleType) in.scale, keyReferenceOctave);
+        }
+
+        // Traslada el acorde de referencia a la octava de 'note'. Las teclas extremas pueden sacar
+        // notas del rango MIDI: se descartan.
+        void placeKeyChord(const ChordNotes& chord, int note, ChordNotes& out)
+        {
+            const int shift = 12 * (note / 12 - keyReferenceOctave);
+            out.size = 0;
+            for (int n : chord)
+                if (n + shift >= 0 && n + shift <= 127)
+                    out.notes[(size_t) out.size++] = n + shift;
+        }
+
+        // Preferencia sin acorde previo: I, V, IV, vi, ii, iii, vii
+        constexpr int harmonyPreference[8] = { 7, 0, 4, 5, 2, 1, 3, 6 };
+
+        // Cercanía entre acordes: para cada nota de 'to', la distancia a la nota más próxima de 'from'
+        int chordDistance(const ChordNotes& from, const ChordNotes& to)
+        {
+            int sum = 0;
+            for (int n : to)
+            {
+                int nearest = 127;
+                for (int m : from)
+                    nearest = juce::jmin(nearest, std::abs(n - m));
+                sum += nearest;
+            }
+            return sum;
+        }
+
+        template <size_t N>
+        const int* tableOf(const int (&t)[N], int& numDegrees)
+        {
+            numDegrees = (int) N;
+            return t;
+        }
+    }
+
+    const int* getPresetDegrees(ProgressionPreset preset, int& numDegrees)
+    {
+        switch (preset)
+        {
+            case ProgressionPreset::I_V_vi_IV: return tableOf(degreesI_V_vi_IV, numDegrees);
+            case ProgressionPreset::ii_V_I:    return tableOf(degreesii_V_I, numDegrees);
+            case ProgressionPreset::I_vi_IV_V: return tableOf(degreesI_vi_IV_V, numDegrees);
+            case ProgressionPreset::vi_IV_I_V: return tableOf(degreesvi_IV_I_V, numDegrees);
+            case ProgressionPreset::Custom:    numDegrees = 0; return nullptr;
+            default:                           return tableOf(degreesI_V_vi_IV, numDegrees);
+        }
+    }
+
+    std::vector<int> getProgressionDegrees(ProgressionPreset preset, const juce::String& customString)
+    {
+        std::vector<int> degrees;
+        if (preset == ProgressionPreset::Custom)
+            degrees = parseProgressionString(customString);
+        else
+        {
+            int n = 0;
+            const int* table = getPresetDegrees(preset, n);
+            degrees.assign(table, table + n);
+        }
+
+        if (degrees.empty())
+            degrees = { 1, 5, 6, 4 };
+        return degrees;
+    }
+
+    PlanInputs readPlanInputs(const juce::AudioProcessorValueTreeState& apvts)
+    {
+        PlanInputs in;
+        in.preset    = loadPlanParam(apvts, ParamID::progressionPreset);
+        in.key       = loadPlanParam(apvts, ParamID::key);
+        in.scale     = loadPlanParam(apvts, ParamID::scale);
+        in.quality   = loadPlanParam(apvts, ParamID::chordQuality);
+        in.inversion = loadPlanParam(apvts, ParamID::inversion);
+        in.octave    = loadPlanParam(apvts, ParamID::octave);
+        in.toggles   = { loadPlanParam(apvts, ParamID::add7) != 0, loadPlanParam(apvts, ParamID::add9) != 0,
+                         loadPlanParam(apvts, ParamID::add11) != 0, loadPlanParam(apvts, ParamID::add13) != 0 };
+        return in;
+    }
+
+    //==============================================================================
+    ProgressionPlan ProgressionPlan::build(const PlanInputs& inputs, const juce::String& customString, juce::uint32 version)
+    {
+        ProgressionPlan plan;
+        plan.version = version;
+        plan.inputs = inputs;
+        plan.customString = customString;
+
+        auto degrees = getProgressionDegrees((ProgressionPreset) inputs.preset, customString);
+        if ((int) degrees.size() > maxSteps)
+            degrees.resize((size_t) maxSteps);
+
+        // Pasos y teclas se resuelven en un solo lote (mismo resultado que makeChordNotes)
+        const auto scale = (ScaleType) inputs.scale;
+        const auto quality = (ChordQuality) inputs.quality;
+        ChordBatch batch;
+        batch.resize((int) degrees.size() + 7 + 7);
+
+        int batchSize = 0;
+        for (int deg : degrees)
+        {
+            plan.degrees[(size_t) plan.numSteps++] = deg;
+            batch.set(batchSize++, degreeToMidi(deg, inputs.key, scale, inputs.octave), scale, quality, inputs.inversion, inputs.toggles);
+        }
+
+        // Teclado: un acorde de referencia por grado; cada tecla lo traslada a su octava
+        const int keyChordsIndex = batchSize;
+        for (int deg = 1; deg <= 7; ++deg)
+            batch.set(batchSize++, keyChordRoot(inputs, deg), scale, quality, inputs.inversion, inputs.toggles);
+
+        const int degreeChordsIndex = batchSize;
+        for (int deg = 1; deg <= 7; ++deg)
+            batch.set(batchSize++, degreeToMidi(deg, inputs.key, scale, inputs.octave), scale, quality, inputs.inversion, inputs.toggles);
+
+        batch.resize(batchSize);
+        makeChordNotesBatch(batch);
+
+        juce::StringArray chordStrings;
+        for (int step = 0; step < plan.numSteps; ++step)
+        {
+            batch.get(step, plan.chords[(size_t) step]);
+            chordStrings.add("[" + notesToString(plan.chords[(size_t) step]) + "]");
+        }
+
+        for (int note = 0; note < numKeys; ++note)
+        {
+            auto& out = plan.keyChords[(size_t) note];
+            out.size = 0;
+            if (const int degree = whiteKeyDegrees[note % 12]; degree != 0)
+            {
+                ChordNotes chord;
+                batch.get(keyChordsIndex + degree - 1, chord);
+                placeKeyChord(chord, note, out);
+            }
+        }
+
+        for (int deg = 1; deg <= 7; ++deg)
+            batch.get(degreeChordsIndex + deg - 1, plan.degreeChords[(size_t) deg]);
+
+        for (int previous = 0; previous <= 7; ++previous)
+            for (int pc = 0; pc < 12; ++pc)
+                plan.harmonyChoice[(size_t) previous][(size_t) pc]
+                    = (juce::uint8) chooseHarmonyDegree(inputs, plan.degreeChords, pc, previous);
+
+        plan.summary = chordStrings.joinIntoString(" | ");
+        plan.roman = degreesToRoman(degrees, scale != ScaleType::Major);
+        return plan;
+    }
+
+    int ProgressionPlan::resolveDegrees(const PlanInputs& live, const int*& degreesOut) const noexcept
+    {
+        if (live.preset == inputs.preset)
+        {
+            degreesOut = degrees.data();
+            return numSteps;
+        }
+
+        // Preset cambiado y plan pendiente de reconstruir. Custom necesita parsear texto: hasta que
+        // llegue el plan nuevo se usa la progresión por defecto.
+        int n = 0;
+        degreesOut = getPresetDegrees((ProgressionPreset) live.preset, n);
+        if (n == 0)
+            degreesOut = getPresetDegrees(ProgressionPreset::I_V_vi_IV, n);
+        return n;
+    }
+
+    const ChordNotes& ProgressionPlan::resolveChord(const PlanInputs& live, const int* stepDegrees, int step, ChordNotes& scratch) const noexcept
+    {
+        if (live == inputs)
+            return chords[(size_t) step];
+
+        const auto scale = (ScaleType) live.scale;
+        const int root = degreeToMidi(stepDegrees[step], live.key, scale, live.octave);
+        makeChordNotes(root, scale, (ChordQuality) live.quality, live.inversion, live.toggles, scratch);
+        return scratch;
+    }
+
+    const ChordNotes& ProgressionPlan::resolveKeyChord(const PlanInputs& live, int note, ChordNotes& scratch) const noexcept
+    {
+        note = juce::jlimit(0, numKeys - 1, note);
+        if (live.sameKeyboardAs(inputs))
+            return keyChords[(size_t) note];
+
+        makeKeyChord(live, note, scratch);
+        return scratch;
+    }
+
+    void ProgressionPlan::makeKeyChord(const PlanInputs& in, int note, ChordNotes& out) noexcept
+    {
+        out.size = 0;
+        const int degree = whiteKeyDegrees[note % 12];
+        if (degree == 0)
+            return;
+
+        ChordNotes chord;
+        makeChordNotes(keyChordRoot(in, degree), (ScaleType) in.scale, (ChordQuality) in.quality, in.inversion, in.toggles, chord);
+        placeKeyChord(chord, note, out);
+    }
+
+    int ProgressionPlan::keyChordDegree(int note) noexcept
+    {
+        return whiteKeyDegrees[juce::jlimit(0, numKeys - 1, note) % 12];
+    }
+
+    const ChordNotes& ProgressionPlan::resolveDegreeChord(const PlanInputs& live, int degree, ChordNotes& scratch) const noexcept
+    {
+        degree = juce::jlimit(1, 7, degree);
+        if (live.sameChordsAs(inputs))
+            return degreeChords[(size_t) degree];
+
+        const auto scale = (ScaleType) live.scale;
+        makeChordNotes(degreeToMidi(degree, live.key, scale, live.octave), scale, (ChordQuality) live.quality,
+                       live.inversion, live.toggles, scratch);
+        return scratch;
+    }
+
+    const ChordNotes& ProgressionPlan::resolveHarmonyChord(const PlanInputs& live, int note, int previousDegree,
+                                                           ChordNotes& scratch, int& degreeOut) const noexcept
+    {
+        const int pc = juce::jlimit(0, 127, note) % 12;
+        previousDegree = juce::jlimit(0, 7, previousDegree);
+
+        if (live.sameChordsAs(inputs))
+        {
+            degreeOut = harmonyChoice[(size_t) previousDegree][(size_t) pc];
+            if (degreeOut == 0)
+            {
+                scratch.size = 0;
+                return scratch;
+            }
+            return degreeChords[(size_t) degreeOut];
+        }
+
+        // Plan pendiente de reconstruir: se evalúan los siete acordes con los ajustes 'live'
+        std::array<ChordNotes, 8> chords {};
+        const auto scale = (ScaleType) live.scale;
+        for (int deg = 1; deg <= 7; ++deg)
+            makeChordNotes(degreeToMidi(deg, live.key, scale, live.octave), scale, (ChordQuality) live.quality,
+                           live.inversion, live.toggles, chords[(size_t) deg]);
+
+        degreeOut = chooseHarmonyDegree(live, chords, pc, previousDegree);
+        scratch = chords[(size_t) degreeOut];
+        if (degreeOut == 0)
+            scratch.size = 0;
+        return scratch;
+    }
+
+    int ProgressionPlan::chooseHarmonyDegree(const PlanInputs& in, const std::array<ChordNotes, 8>& chords,
+                                             int pitchClass, int previousDegree) noexcept
+    {
+        // Orden: cercanía al acorde anterior, la nota como fundamental, preferencia funcional
+        int best = 0;
+        int bestDistance = 0, bestRank = 0;
+        for (int deg = 1; deg <= 7; ++deg)
+        {
+            const auto& chord = chords[(size_t) deg];
+            if (std::none_of(chord.begin(), chord.end(), [pitchClass](int n) { return n % 12 == pitchClass; }))
+                continue;
+
+            const int distance = previousDegree > 0 ? chordDistance(chords[(size_t) previousDegree], chord) : 0;
+            const int rootPc = degreeToMidi(deg, in.key, (ScaleType) in.scale, 0) % 12;
+            const int rank = (rootPc == pitchClass ? 0 : 8) + harmonyPreference[deg];
+
+            if (best == 0 || distance < bestDistance || (distance == bestDistance && rank < bestRank))
+            {
+                best = deg;
+                bestDistance = distance;
+                bestRank = rank;
+            }
+        }
+        return best;
+    }
+
+    //==============================================================================
+    ProgressionPlanCache::ProgressionPlanCache(juce::AudioProcessorValueTreeState& s)
+        : apvts(s)
+    {
+        for (auto* id : planParamIDs)
+            apvts.addParameterListener(id, this);
+        apvts.state.addListener(this);
+        rebuildNow();
+    }
+
+    ProgressionPlanCache::~ProgressionPlanCache()
+    {
+        cancelPendingUpdate();
+        apvts.state.removeListener(this);
+        for (auto* id : planParamIDs)
+            apvts.removeParameterListener(id, this);
+    }
+
+    const ProgressionPlan& ProgressionPlanCache::acquireForAudio() noexcept
+    {
+        // Puntero de peligro: se anuncia el plan antes de usarlo y se confirma que sigue publicado,
+        // así el hilo de mensajes nunca libera un plan que el audio esté leyendo
+        auto* plan = published.load();
+        for (;;)
+        {
+            hazard.store(plan);
+            auto* check = published.load();
+            if (check == plan)
+                return *plan;
+            plan = check;
+        }
+    }
+
+    void ProgressionPlanCache::rebuildNow()
+    {
+        JUCE_ASSERT_MESSAGE_THREAD
+
+        const auto inputs = readPlanInputs(apvts);
+        const auto customString = apvts.state.getProperty(ParamID::progressionCustom, juce::String("1-5-6-4")).toString();
+
+        // Solo el texto custom usado importa: con un preset fijo editar el texto no invalida el plan
+        const bool isCustom = (ProgressionPreset) inputs.preset == ProgressionPreset::Custom;
+        if (current != nullptr && current->inputs == inputs && (! isCustom || current->customString == customString))
+            return;
+
+        auto plan = std::make_shared<const ProgressionPlan>(ProgressionPlan::build(inputs, customString, nextVersion++));
+
+        if (current != nullptr)
+            retired.push_back(current);
+        current = plan;
+        published.store(plan.get());
+
+        // Libera los planes retirados que el audio ya no puede estar leyendo
+        auto* inUse = hazard.load();
+        retired.erase(std::remove_if(retired.begin(), retired.end(),
+                                     [inUse](const auto& p) { return p.get() != inUse; }),
+                      retired.end());
+
+        if (onPlanChanged)
+            onPlanChanged(*plan);
+        sendChangeMessage();
+    }
+
+    void ProgressionPlanCache::parameterChanged(const juce::String&, float)
+    {
+        // Puede llegar desde el hilo de audio (automatización): la reconstrucción va al hilo de mensajes
+        triggerAsyncUpdate();
+    }
+
+    void ProgressionPlanCache::valueTreePropertyChanged(juce::ValueTree&, const juce::Identifier& property)
+    {
+        if (property == customStringID)
+            triggerAsyncUpdate();
+    }
+
+    void ProgressionPlanCache::valueTreeRedirected(juce::ValueTree&)
+    {
+        // replaceState (carga de preset/sesión)
+        triggerAsyncUpdate();
+    }
+
+    void ProgressionPlanCache::handleAsyncUpdate()
+    {
+        rebuildNow();
+    }
+}
@@ -0,0 +1,171 @@
+// ProgressionPlan.h
+// Plan de progresión memoizado (grados + acordes resueltos) compartido por reproducción, exportación y UI
+
+#pragma once
+
+#include <juce_audio_processors/juce_audio_processors.h>
+#include <array>
+#include "Parameters.h"
+#include "Theory.h"
+#include "ChordBatch.h"
+#include "Utils.h"
+
+namespace cc
+{
+    // Grados de un preset (tabla estática, sin asignaciones). Custom devuelve 0 grados.
+    const int* getPresetDegrees(ProgressionPreset preset, int& numDegrees);
+
+    // Grados de la progresión según preset/custom; nunca vacío (por defecto 1-5-6-4)
+    std::vector<int> getProgressionDegrees(ProgressionPreset preset, const juce::String& customString);
+
+    // Valores de parámetros de los que depende el plan
+    struct PlanInputs
+    {
+        int preset = 0, key = 0, scale = 0, quality = 0, inversion = 0, octave = 4;
+        ExtensionToggles toggles;
+
+        bool operator==(const PlanInputs& o) const
+        {
+            return preset == o.preset && key == o.key && scale == o.scale && quality == o.quality && inversion == o.inversion
+                && octave == o.octave && toggles.add7 == o.toggles.add7 && toggles.add9 == o.toggles.add9
+                && toggles.add11 == o.toggles.add11 && toggles.add13 == o.toggles.add13;
+        }
+        bool operator!=(const PlanInputs& o) const { return ! (*this == o); }
+
+        // El mapa de teclado no depende del preset ni de la octava
+        bool sameKeyboardAs(const PlanInputs& o) const
+        {
+            PlanInputs a = *this;
+            a.preset = o.preset;
+            a.octave = o.octave;
+            return a == o;
+        }
+
+        // Los acordes diatónicos (armonizador) no dependen del preset
+        bool sameChordsAs(const PlanInputs& o) const
+        {
+            PlanInputs a = *this;
+            a.preset = o.preset;
+            return a == o;
+        }
+    };
+
+    PlanInputs readPlanInputs(const juce::AudioProcessorValueTreeState& apvts);
+
+    // Plan inmutable: se construye en el hilo de mensajes y se publica ya terminado
+    struct ProgressionPlan
+    {
+        static constexpr int maxSteps = 64;
+        static constexpr int numKeys = 128;
+
+        juce::uint32 version = 0;
+        PlanInputs inputs;
+        juce::String customString;
+
+        std::array<int, maxSteps> degrees {};
+        std::array<ChordNotes, maxSteps> chords {};
+        int numSteps = 0;
+
+        // Modo teclado: acorde por nota de entrada (vacío = la tecla no dispara acorde)
+        std::array<ChordNotes, numKeys> keyChords {};
+
+        // Armonizador: acordes de los grados 1..7 y elección [grado anterior (0 = ninguno)][clase de nota]
+        // -> grado (0 = nota cromática, sin acorde). Empates resueltos por cercanía al acorde anterior.
+        std::array<ChordNotes, 8> degreeChords {};
+        std::array<std::array<juce::uint8, 12>, 8> harmonyChoice {};
+
+        juce::String summary;  // "[C4 E4 G4] | [G3 B3 D4] ..." para la UI
+        juce::String roman;    // "I-V-vi-IV"
+
+        static ProgressionPlan build(const PlanInputs& inputs, const juce::String& customString, juce::uint32 version);
+
+        // Grados vigentes para 'live': los del plan o, si el preset cambió y el plan aún no se ha
+        // reconstruido, la tabla estática del preset. Devuelve el número de pasos (> 0).
+        int resolveDegrees(const PlanInputs& live, const int*& degreesOut) const noexcept;
+
+        // Acorde del paso 'step' (grados de resolveDegrees) con los ajustes 'live': el memoizado si el plan
+        // se construyó con los mismos ajustes; si no, se calcula en 'scratch' sin asignar memoria.
+        const ChordNotes& resolveChord(const PlanInputs& live, const int* degrees, int step, ChordNotes& scratch) const noexcept;
+
+        // Acorde de la tecla 'note' en modo teclado: una consulta a keyChords si coincide con 'live'
+        const ChordNotes& resolveKeyChord(const PlanInputs& live, int note, ChordNotes& scratch) const noexcept;
+
+        // Teclas blancas -> grados diatónicos (C = I ... B = VII); la octava de la tecla fija el registro
+        static void makeKeyChord(const PlanInputs& inputs, int note, ChordNotes& out) noexcept;
+        static int keyChordDegree(int note) noexcept;  // 0 = tecla negra
+
+        // Acorde del grado 'degree' (1..7) con los ajustes 'live': una consulta a degreeChords si coinciden
+        const ChordNotes& resolveDegreeChord(const PlanInputs& live, int degree, ChordNotes& scratch) const noexcept;
+
+        // Armonizador: acorde para la nota de melodía 'note' tras el grado 'previousDegree'.
+        // Con el plan al día son dos consultas a tabla; 'degreeOut' = 0 si la nota no es diatónica.
+        const ChordNotes& resolveHarmonyChord(const PlanInputs& live, int note, int previousDegree,
+                                              ChordNotes& scratch, int& degreeOut) const noexcept;
+
+        // Grado elegido para 'pitchClass' dados los acordes diatónicos (índices 1..7) y el grado anterior
+        static int chooseHarmonyDegree(const PlanInputs& inputs, const std::array<ChordNotes, 8>& chords,
+                                       int pitchClass, int previousDegree) noexcept;
+    };
+
+    // Mantiene el plan actual. Se reconstruye solo cuando cambia un parámetro relevante o el texto
+    // custom (listeners de APVTS/ValueTree -> AsyncUpdater en el hilo de mensajes).
+    // Lectura:
+    //  - hilo de audio: acquireForAudio()/releaseForAudio() (puntero protegido, sin bloqueos)
+    //  - hilo de mensajes: getPlan() (shared_ptr); los ChangeListener se avisan tras cada plan nuevo
+    class ProgressionPlanCache : public juce::ChangeBroadcaster,
+                                 private juce::AudioProcessorValueTreeState::Listener,
+                                 private juce::ValueTree::Listener,
+                                 private juce::AsyncUpdater
+    {
+    public:
+        explicit ProgressionPlanCache(juce::AudioProcessorValueTreeState& apvts);
+        ~ProgressionPlanCache() override;
+
+        // Hilo de audio: el plan devuelto es válido hasta releaseForAudio()
+        const ProgressionPlan& acquireForAudio() noexcept;
+        void releaseForAudio() noexcept { hazard.store(nullptr); }
+
+        // Hilo de mensajes
+        std::shared_ptr<const ProgressionPlan> getPlan() const { return current; }
+        void rebuildNow();
+
+        // Se llama en el hilo de mensajes tras publicar un plan nuevo
+        std::function<void(const ProgressionPlan&)> onPlanChanged;
+
+    private:
+        void parameterChanged(const juce::String& parameterID, float newValue) override;
+        void valueTreePropertyChanged(juce::ValueTree& tree, const juce::Identifier& property) override;
+        void valueTreeRedirected(juce::ValueTree& tree) override;
+        void handleAsyncUpdate() override;
+
+        PlanInputs readInputs() const;
+
+        juce::AudioProcessorValueTreeState& apvts;
+        const juce::Identifier customStringID { ParamID::progressionCustom };
+
+        std::shared_ptr<const ProgressionPlan> current;               // propiedad (hilo de mensajes)
+        std::vector<std::shared_ptr<const ProgressionPlan>> retired;  // pendientes de liberar
+        std::atomic<const ProgressionPlan*> published { nullptr };
+        std::atomic<const ProgressionPlan*> hazard { nullptr };       // plan en uso por el hilo de audio
+        juce::uint32 nextVersion = 1;
+
+        JUCE_DECLARE_NON_COPYABLE(ProgressionPlanCache)
+    };
+
+    // Protege el plan durante un bloque de audio
+    class ScopedPlanAccess
+    {
+    public:
+        explicit ScopedPlanAccess(ProgressionPlanCache& c) noexcept : cache(c), plan(c.acquireForAudio()) {}
+        ~ScopedPlanAccess() { cache.releaseForAudio(); }
+
+        const ProgressionPlan& operator*() const noexcept  { return plan; }
+        const ProgressionPlan* operator->() const noexcept { return &plan; }
+
+    private:
+        ProgressionPlanCache& cache;
+        const ProgressionPlan& plan;
+
+        JUCE_DECLARE_NON_COPYABLE(ScopedPlanAccess)
+    };
+}
@@ -0,0 +1,390 @@
+// SessionRecorder.cpp
+
+#include "SessionRecorder.h"
+
+namespace cc
+{
+    namespace
+    {
+        constexpr char sessionMagic[4] = { 'C', 'C', 'S', 'R' };
+
+        enum PositionFlags : juce::uint8
+        {
+            hasPosition  = 1 << 0,
+            isPlaying    = 1 << 1,
+            hasPpq       = 1 << 2,
+            hasBarStart  = 1 << 3,
+            hasBpm       = 1 << 4,
+            hasSamples   = 1 << 5,
+            hasTimeSig   = 1 << 6
+        };
+
+        // Escritura secuencial en un buffer fijo; 'ok' pasa a false si no cabe
+        struct RecordWriter
+        {
+            juce::uint8* data;
+            size_t capacity;
+            size_t size = 0;
+            bool ok = true;
+
+            template <typename T>
+            void put(const T& value) noexcept { putBytes(&value, sizeof(T)); }
+
+            void putBytes(const void* src, size_t n) noexcept
+            {
+                if (! ok || size + n > capacity)
+                {
+                    ok = false;
+                    return;
+                }
+                std::memcpy(data + size, src, n);
+                size += n;
+            }
+        };
+
+        // Lectura secuencial con comprobación de límites
+        struct RecordReader
+        {
+            const juce::uint8* data;
+            size_t size;
+            size_t pos = 0;
+            bool ok = true;
+
+            template <typename T>
+            T get() noexcept
+            {
+                T value {};
+                getBytes(&value, sizeof(T));
+                return value;
+            }
+
+            const juce::uint8* getBytes(void* dest, size_t n) noexcept
+            {
+                if (! ok || pos + n > size)
+                {
+                    ok = false;
+                    return nullptr;
+                }
+                const auto* src = data + pos;
+                if (dest != nullptr)
+                    std::memcpy(dest, src, n);
+                pos += n;
+                return src;
+            }
+        };
+    }
+
+    //==============================================================================
+    // Hilo escritor: vacía el ring al archivo periódicamente; al parar vuelca lo que quede
+    class SessionRecorder::Writer : public juce::Thread
+    {
+    public:
+        Writer(SessionRecorder& o, std::unique_ptr<juce::FileOutputStream> s)
+            : juce::Thread("ChordCompanion session writer"), owner(o), stream(std::move(s)) {}
+
+        ~Writer() override { stopThread(2000); }
+
+        void run() override
+        {
+            while (! threadShouldExit())
+            {
+                wait(20);
+                drain();
+            }
+            drain();
+            stream->flush();
+        }
+
+    private:
+        void drain()
+        {
+            auto& fifo = owner.fifo;
+            int start1, size1, start2, size2;
+            fifo.prepareToRead(fifo.getNumReady(), start1, size1, start2, size2);
+            if (size1 > 0) stream->write(owner.ring.data() + start1, (size_t) size1);
+            if (size2 > 0) stream->write(owner.ring.data() + start2, (size_t) size2);
+            fifo.finishedRead(size1 + size2);
+        }
+
+        SessionRecorder& owner;
+        std::unique_ptr<juce::FileOutputStream> stream;
+    };
+
+    SessionRecorder::SessionRecorder() = default;
+
+    SessionRecorder::~SessionRecorder()
+    {
+        stop();
+    }
+
+    bool SessionRecorder::start(const juce::File& dest, const SessionHeader& header,
+                                const juce::Array<juce::AudioProcessorParameter*>& params)
+    {
+        stop();
+
+        auto stream = std::make_unique<juce::FileOutputStream>(dest);
+        if (! stream->openedOk())
+            return false;
+        stream->setPosition(0);
+        stream->truncate();
+
+        const int numParams = juce::jmin(maxParams, params.size(), header.paramIDs.size());
+
+        stream->write(sessionMagic, sizeof(sessionMagic));
+        const juce::uint32 version = SessionHeader::version;
+        stream->write(&version, sizeof(version));
+        stream->write(&header.sampleRate, sizeof(header.sampleRate));
+        const auto maxBlock = (juce::uint32) header.maxBlockSize;
+        stream->write(&maxBlock, sizeof(maxBlock));
+        const auto count = (juce::uint32) numParams;
+        stream->write(&count, sizeof(count));
+        for (int i = 0; i < numParams; ++i)
+        {
+            const auto id = header.paramIDs[i].toStdString();
+            const auto len = (juce::uint16) id.size();
+            stream->write(&len, sizeof(len));
+            stream->write(id.data(), id.size());
+        }
+        const auto custom = header.customProgression.toStdString();
+        const auto customLen = (juce::uint32) custom.size();
+        stream->write(&customLen, sizeof(customLen));
+        stream->write(custom.data(), custom.size());
+
+        // Todo lo que toca el hilo de audio se prepara antes de publicar 'recording'
+        if (ring.empty())
+            ring.resize((size_t) ringBytes);
+        fifo.reset();
+        parameters.assign(params.begin(), params.begin() + numParams);
+        firstBlock = true;
+        droppedSinceLast = 0;
+        numCommands = 0;
+        dropped = 0;
+
+        writer = std::make_unique<Writer>(*this, std::move(stream));
+        writer->startThread();
+        recording = true;
+        return true;
+    }
+
+    void SessionRecorder::stop()
+    {
+        recording = false;
+        // Un bloque que ya vio 'recording' termina su registro antes de parar el escritor
+        while (busy.load())
+            juce::Thread::yield();
+
+        writer.reset();  // el escritor vuelca lo pendiente y cierra el archivo
+    }
+
+    void SessionRecorder::addCommand(const Command& c) noexcept
+    {
+        if (isRecording() && numCommands < (int) commands.size())
+            commands[(size_t) numCommands++] = c;
+    }
+
+    void SessionRecorder::recordBlock(const juce::MidiBuffer& midiIn, int numSamples,
+                                      const juce::AudioPlayHead::PositionInfo* position) noexcept
+    {
+        busy = true;
+        if (! recording.load())
+        {
+            busy = false;
+            return;
+        }
+
+        RecordWriter w { record.data(), record.size() };
+        w.put((juce::uint32) 0);  // tamaño, se rellena al final
+        w.put(droppedSinceLast);
+        w.put((juce::uint32) numSamples);
+
+        // Posición del host
+        juce::uint8 flags = 0;
+        double ppq = 0.0, barStart = 0.0, bpm = 0.0;
+        juce::int64 samples = 0;
+        juce::uint16 timeSig = 0;
+        if (position != nullptr)
+        {
+            flags |= hasPosition;
+            if (position->getIsPlaying()) flags |= isPlaying;
+            if (auto v = position->getPpqPosition())               { flags |= hasPpq;      ppq = *v; }
+            if (auto v = position->getPpqPositionOfLastBarStart()) { flags |= hasBarStart; barStart = *v; }
+            if (auto v = position->getBpm())                       { flags |= hasBpm;      bpm = *v; }
+            if (auto v = position->getTimeInSamples())             { flags |= hasSamples;  samples = *v; }
+            if (auto v = position->getTimeSignature())
+            {
+                flags |= hasTimeSig;
+                timeSig = (juce::uint16) ((v->numerator & 0xff) << 8 | (v->denominator & 0xff));
+            }
+        }
+        w.put(flags);
+        w.put(ppq);
+        w.put(barStart);
+        w.put(bpm);
+        w.put(samples);
+        w.put(timeSig);
+
+        // Parámetros: en el primer bloque todos, después solo los que cambiaron
+        std::array<float, maxParams> values {};
+        const auto numChangedPos = w.size;
+        juce::uint16 numChanged = 0;
+        w.put(numChanged);
+        for (size_t i = 0; i < parameters.size(); ++i)
+        {
+            values[i] = parameters[i]->getValue();
+            if (firstBlock || values[i] != lastValues[i])
+            {
+                w.put((juce::uint16) i);
+                w.put(values[i]);
+                ++numChanged;
+            }
+        }
+        if (w.ok)
+            std::memcpy(record.data() + numChangedPos, &numChanged, sizeof(numChanged));
+
+        w.put((juce::uint8) numCommands);
+        for (int i = 0; i < numCommands; ++i)
+        {
+            w.put((juce::uint8) commands[(size_t) i].type);
+            w.put((juce::int32) commands[(size_t) i].value);
+        }
+        numCommands = 0;
+
+        // MIDI de entrada con el mismo formato que MidiBuffer::data
+        const auto midiSizePos = w.size;
+        w.put((juce::uint32) 0);
+        for (const auto meta : midiIn)
+        {
+            w.put((juce::int32) meta.samplePosition);
+            w.put((juce::uint16) meta.numBytes);
+            w.putBytes(meta.data, (size_t) meta.numBytes);
+        }
+
+        if (w.ok)
+        {
+            const auto midiBytes = (juce::uint32) (w.size - midiSizePos - sizeof(juce::uint32));
+            std::memcpy(record.data() + midiSizePos, &midiBytes, sizeof(midiBytes));
+            const auto total = (juce::uint32) w.size;
+            std::memcpy(record.data(), &total, sizeof(total));
+
+            int start1, size1, start2, size2;
+            fifo.prepareToWrite((int) w.size, start1, size1, start2, size2);
+            if (size1 + size2 == (int) w.size)
+            {
+                std::memcpy(ring.data() + start1, record.data(), (size_t) size1);
+                if (size2 > 0)
+                    std::memcpy(ring.data() + start2, record.data() + size1, (size_t) size2);
+                fifo.finishedWrite((int) w.size);
+
+                // Las diferencias del siguiente bloque se calculan contra lo que quedó en el archivo
+                lastValues = values;
+                firstBlock = false;
+                droppedSinceLast = 0;
+                busy = false;
+                return;
+            }
+        }
+
+        // Ring lleno (disco lento) o registro demasiado grande: se pierde el bloque entero
+        ++droppedSinceLast;
+        dropped.fetch_add(1, std::memory_order_relaxed);
+        busy = false;
+    }
+
+    //==============================================================================
+    bool SessionReader::open(const juce::File& source)
+    {
+        data.reset();
+        cursor = 0;
+        header = {};
+        if (! source.loadFileAsData(data))
+            return false;
+
+        RecordReader r { static_cast<const juce::uint8*>(data.getData()), data.getSize() };
+        char magic[4] {};
+        r.getBytes(magic, sizeof(magic));
+        if (! r.ok || std::memcmp(magic, sessionMagic, sizeof(magic)) != 0)
+            return false;
+        if (r.get<juce::uint32>() != SessionHeader::version)
+            return false;
+
+        header.sampleRate = r.get<double>();
+        header.maxBlockSize = (int) r.get<juce::uint32>();
+        const auto numParams = r.get<juce::uint32>();
+        for (juce::uint32 i = 0; i < numParams && r.ok; ++i)
+        {
+            const auto len = r.get<juce::uint16>();
+            if (const auto* bytes = r.getBytes(nullptr, len))
+                header.paramIDs.add(juce::String::fromUTF8(reinterpret_cast<const char*>(bytes), (int) len));
+        }
+        const auto customLen = r.get<juce::uint32>();
+        if (const auto* bytes = r.getBytes(nullptr, customLen))
+            header.customProgression = juce::String::fromUTF8(reinterpret_cast<const char*>(bytes), (int) customLen);
+
+        cursor = r.pos;
+        return r.ok && header.sampleRate > 0.0 && header.maxBlockSize > 0;
+    }
+
+    bool SessionReader::next(ReplayBlock& block)
+    {
+        const auto* base = static_cast<const juce::uint8*>(data.getData());
+        RecordReader r { base + cursor, data.getSize() - cursor };
+        const auto total = r.get<juce::uint32>();
+        if (! r.ok || total < sizeof(juce::uint32) || total > r.size)
+            return false;
+        r.size = total;
+
+        block.droppedBefore = r.get<juce::uint32>();
+        block.numSamples = (int) r.get<juce::uint32>();
+
+        const auto flags = r.get<juce::uint8>();
+        const auto ppq = r.get<double>();
+        const auto barStart = r.get<double>();
+        const auto bpm = r.get<double>();
+        const auto samples = r.get<juce::int64>();
+        const auto timeSig = r.get<juce::uint16>();
+
+        block.hasPosition = (flags & hasPosition) != 0;
+        block.position = {};
+        block.position.setIsPlaying((flags & isPlaying) != 0);
+        if (flags & hasPpq)      block.position.setPpqPosition(ppq);
+        if (flags & hasBarStart) block.position.setPpqPositionOfLastBarStart(barStart);
+        if (flags & hasBpm)      block.position.setBpm(bpm);
+        if (flags & hasSamples)  block.position.setTimeInSamples(samples);
+        if (flags & hasTimeSig)  block.position.setTimeSignature(juce::AudioPlayHead::TimeSignature { timeSig >> 8, timeSig & 0xff });
+
+        block.paramChanges.clear();
+        const auto numChanged = r.get<juce::uint16>();
+        for (int i = 0; i < numChanged && r.ok; ++i)
+        {
+            const int index = r.get<juce::uint16>();
+            const float value = r.get<float>();
+            block.paramChanges.emplace_back(index, value);
+        }
+
+        block.commands.clear();
+        const auto numCommands = r.get<juce::uint8>();
+        for (int i = 0; i < numCommands && r.ok; ++i)
+        {
+            Command c;
+            c.type = (Command::Type) r.get<juce::uint8>();
+            c.value = r.get<juce::int32>();
+            block.commands.push_back(c);
+        }
+
+        block.midi.clear();
+        const auto midiBytes = r.get<juce::uint32>();
+        const auto midiEnd = r.pos + midiBytes;
+        while (r.ok && r.pos < midiEnd)
+        {
+            const auto samplePosition = r.get<juce::int32>();
+            const auto numBytes = r.get<juce::uint16>();
+            if (const auto* bytes = r.getBytes(nullptr, numBytes))
+                block.midi.addEvent(bytes, (int) numBytes, samplePosition);
+        }
+
+        if (! r.ok)
+            return false;
+        cursor += total;
+        return true;
+    }
+}
@@ -0,0 +1,122 @@
+// SessionRecorder.h
+// Grabación de sesiones para reproducirlas offline: por bloque, MIDI de entrada, tamaño, posición del host,
+// cambios de parámetros y órdenes del editor. Ring de bytes lock-free volcado a disco por un hilo escritor.
+
+#pragma once
+
+#include <juce_audio_processors/juce_audio_processors.h>
+#include <array>
+#include <atomic>
+#include <vector>
+#include "CommandQueue.h"
+
+namespace cc
+{
+    // Formato (binario, orden de bytes nativo):
+    //   cabecera: "CCSR", u32 versión, f64 sampleRate, u32 maxBlockSize, u32 numParams,
+    //             numParams x (u16 longitud + id UTF-8), u32 longitud + progresión custom
+    //   bloques:  u32 tamaño del registro, u32 bloques perdidos antes de éste, u32 numSamples,
+    //             posición (u8 flags, f64 ppq, f64 inicio de compás, f64 bpm, i64 samples, u16 num/den),
+    //             u16 numCambios x (u16 índice, f32 valor normalizado),
+    //             u8 numÓrdenes x (u8 tipo, i32 valor),
+    //             u32 bytes MIDI, eventos como en MidiBuffer (i32 posición, u16 tamaño, bytes)
+    struct SessionHeader
+    {
+        static constexpr juce::uint32 version = 1;
+
+        double sampleRate = 44100.0;
+        int maxBlockSize = 512;
+        juce::StringArray paramIDs;     // el índice de los cambios se refiere a este orden
+        juce::String customProgression; // no es un parámetro: se guarda una vez
+    };
+
+    class SessionRecorder
+    {
+    public:
+        SessionRecorder();
+        ~SessionRecorder();
+
+        // Hilo de mensajes. 'params' en el mismo orden que header.paramIDs.
+        bool start(const juce::File& dest, const SessionHeader& header,
+                   const juce::Array<juce::AudioProcessorParameter*>& params);
+        void stop();
+        bool isRecording() const noexcept { return recording.load(std::memory_order_relaxed); }
+        int getDroppedBlocks() const noexcept { return dropped.load(std::memory_order_relaxed); }
+
+        // Hilo de audio: órdenes ejecutadas en el bloque en curso (se escriben con recordBlock)
+        void addCommand(const Command& c) noexcept;
+
+        // Hilo de audio: un registro por bloque, sin bloqueos ni asignaciones. Si no cabe en el ring
+        // se descarta entero y el siguiente registro lo cuenta.
+        void recordBlock(const juce::MidiBuffer& midiIn, int numSamples,
+                         const juce::AudioPlayHead::PositionInfo* position) noexcept;
+
+    private:
+        class Writer;
+
+        static constexpr int ringBytes = 1 << 22;
+        static constexpr int maxParams = 256;
+        static constexpr int maxRecordBytes = 1 << 16;  // registros mayores (ráfagas enormes) se descartan
+
+        std::atomic<bool> recording { false };
+        std::atomic<bool> busy { false };  // el hilo de audio está dentro de recordBlock
+        std::atomic<int> dropped { 0 };
+
+        juce::AbstractFifo fifo { ringBytes };
+        std::vector<juce::uint8> ring;                    // reservado en start, nunca en el hilo de audio
+        std::array<juce::uint8, maxRecordBytes> record {}; // registro en construcción
+
+        std::vector<juce::AudioProcessorParameter*> parameters;
+        std::array<float, maxParams> lastValues {};
+        bool firstBlock = true;
+        juce::uint32 droppedSinceLast = 0;
+
+        std::array<Command, CommandQueue::capacity> commands {};
+        int numCommands = 0;
+
+        std::unique_ptr<Writer> writer;
+
+        JUCE_DECLARE_NON_COPYABLE(SessionRecorder)
+    };
+
+    // Un bloque leído de una grabación (buffers reutilizados entre llamadas)
+    struct ReplayBlock
+    {
+        int numSamples = 0;
+        juce::uint32 droppedBefore = 0;
+        bool hasPosition = false;
+        juce::AudioPlayHead::PositionInfo position;
+        std::vector<std::pair<int, float>> paramChanges;
+        std::vector<Command> commands;
+        juce::MidiBuffer midi;
+    };
+
+    // Posición grabada, servida al procesador como su AudioPlayHead durante la reproducción
+    struct ReplayPlayHead : public juce::AudioPlayHead
+    {
+        const ReplayBlock* block = nullptr;
+
+        juce::Optional<PositionInfo> getPosition() const override
+        {
+            if (block != nullptr && block->hasPosition)
+                return block->position;
+            return {};
+        }
+    };
+
+    class SessionReader
+    {
+    public:
+        // Lee el archivo entero en memoria; false si no es una grabación válida
+        bool open(const juce::File& source);
+        const SessionHeader& getHeader() const { return header; }
+
+        // Siguiente bloque; false al final o ante un registro corrupto
+        bool next(ReplayBlock& block);
+
+    private:
+        juce::MemoryBlock data;
+        size_t cursor = 0;
+        SessionHeader header;
+    };
+}
@@ -0,0 +1,30 @@
+// StormGuard.cpp
+
+#include "StormGuard.h"
+
+namespace cc
+{
+    bool StormGuard::passesSoundingFilter(const juce::uint8* data, int size) noexcept
+    {
+        if (size < 3)
+            return true;
+
+        const int status = data[0] & 0xf0;
+        if (status != 0x90 && status != 0x80)
+            return true;
+
+        auto& count = refCounts[(size_t) ((data[0] & 0x0f) * 128 + (data[1] & 0x7f))];
+        if (status == 0x90 && data[2] != 0)
+        {
+            // Solo suena el primer note-on; los siguientes amplían la vida de la nota
+            if (count < 255)
+                ++count;
+            return count == 1;
+        }
+
+        // Note-off: sin referencias (nota anterior al modo tormenta) pasa siempre
+        if (count == 0)
+            return true;
+        return --count == 0;
+    }
+}
@@ -0,0 +1,69 @@
+// StormGuard.h
+// Modo tormenta: agrupa ráfagas de note-ons, evita re-disparar notas que ya suenan y limita eventos por bloque
+
+#pragma once
+
+#include <juce_core/juce_core.h>
+#include <array>
+#include <limits>
+
+namespace cc
+{
+    // Coste acotado ante glissandos, redobles o pads que envían decenas de note-ons por bloque:
+    //  - los note-ons dentro de la ventana del último disparo aceptado (del mismo canal) se consumen sin acorde
+    //  - cada bloque tiene un presupuesto fijo de eventos programados (acordes enteros o nada)
+    //  - en la emisión, un contador por canal/nota suprime note-ons de notas que ya suenan y
+    //    retrasa el note-off hasta soltar la última referencia
+    class StormGuard
+    {
+    public:
+        StormGuard() { reset(); }
+
+        void reset() noexcept
+        {
+            lastTrigger.fill(std::numeric_limits<juce::int64>::min() / 2);
+            refCounts.fill(0);
+            budget = used = 0;
+        }
+
+        // true si el note-on en 'time' abre una ventana nueva en 'channel' (1..16); false si se agrupa con el anterior
+        bool acceptTrigger(juce::int64 time, int windowSamples, int channel = 1) noexcept
+        {
+            auto& last = lastTrigger[(size_t) ((channel - 1) & 15)];
+            if (time - last < windowSamples)
+                return false;
+            last = time;
+            return true;
+        }
+
+        // Sin modo tormenta el presupuesto es ilimitado; al activarlo se parte de un estado limpio
+        void beginBlock(bool enabled, int maxEvents) noexcept
+        {
+            if (enabled && ! wasEnabled)
+                reset();
+            wasEnabled = enabled;
+            budget = enabled ? maxEvents : std::numeric_limits<int>::max();
+            used = 0;
+        }
+
+        bool hasBudget() const noexcept        { return used < budget; }
+
+        // Reserva numEvents del presupuesto del bloque; si no caben no reserva nada
+        bool tryReserve(int numEvents) noexcept
+        {
+            if (used + numEvents > budget)
+                return false;
+            used += numEvents;
+            return true;
+        }
+
+        // Filtro de emisión: false = descartar el evento (nota ya sonando o aún referenciada)
+        bool passesSoundingFilter(const juce::uint8* data, int size) noexcept;
+
+    private:
+        std::array<juce::int64, 16> lastTrigger {};
+        std::array<juce::uint8, 16 * 128> refCounts {};
+        int budget = 0, used = 0;
+        bool wasEnabled = false;
+    };
+}
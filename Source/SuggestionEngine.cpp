@@ -0,0 +1,275 @@
+// SuggestionEngine.cpp
+
+#include "SuggestionEngine.h"
+
+namespace cc
+{
+    namespace
+    {
+        // Coste de transición de práctica común [desde][hacia] (menor = más idiomático). Fila 0 = inicio.
+        constexpr float transitionCost[8][8] =
+        {
+            //       -    1     2     3     4     5     6     7
+            /*0*/ { 0, 0.2f, 0.8f, 1.2f, 0.5f, 0.8f, 0.5f, 1.5f },
+            /*1*/ { 0, 2.0f, 0.4f, 0.8f, 0.2f, 0.2f, 0.4f, 1.0f },
+            /*2*/ { 0, 1.0f, 2.0f, 1.2f, 0.8f, 0.1f, 1.0f, 0.5f },
+            /*3*/ { 0, 1.0f, 0.8f, 2.0f, 0.4f, 1.2f, 0.2f, 1.5f },
+            /*4*/ { 0, 0.3f, 0.6f, 1.2f, 2.0f, 0.2f, 1.0f, 0.6f },
+            /*5*/ { 0, 0.1f, 1.5f, 1.2f, 0.8f, 2.0f, 0.4f, 1.5f },
+            /*6*/ { 0, 1.0f, 0.2f, 0.8f, 0.2f, 0.6f, 2.0f, 1.2f },
+            /*7*/ { 0, 0.1f, 1.5f, 0.6f, 1.5f, 1.2f, 1.0f, 2.0f },
+        };
+
+        constexpr float voiceLeadingPerSemitone = 0.15f;
+        constexpr float pingPongPenalty = 0.6f;
+        constexpr float minCadenceCost = 0.0f;
+
+        // Movimiento mínimo (en semitonos, por clase de altura) entre dos tríadas, probando las 6 asignaciones de voces
+        int minimalMotion(const std::array<int, 3>& a, const std::array<int, 3>& b)
+        {
+            static constexpr int perms[6][3] = { {0,1,2}, {0,2,1}, {1,0,2}, {1,2,0}, {2,0,1}, {2,1,0} };
+            int best = std::numeric_limits<int>::max();
+            for (const auto& p : perms)
+            {
+                int sum = 0;
+                for (int v = 0; v < 3; ++v)
+                {
+                    const int d = std::abs(a[(size_t) v] - b[(size_t) p[v]]) % 12;
+                    sum += juce::jmin(d, 12 - d);
+                }
+                best = juce::jmin(best, sum);
+            }
+            return best;
+        }
+    }
+
+    //==============================================================================
+    struct SuggestionSearch::Frame
+    {
+        int length = 0;
+        int prev2 = 0, prev1 = 0;
+        std::array<int, Suggestion::maxLength> path {};
+        std::vector<Suggestion>& best;  // ordenado por coste total ascendente, como mucho maxResults
+        const std::function<bool()>& shouldAbort;
+    };
+
+    SuggestionSearch::SuggestionSearch(ScaleType scale)
+    {
+        // Tríadas en clase de altura relativas a la tónica (la tonalidad solo transpone)
+        std::array<std::array<int, 3>, 8> triads {};
+        ChordNotes chord;
+        for (int d = 1; d <= 7; ++d)
+        {
+            makeChordNotes(degreeToMidi(d, 0, scale, 5), scale, ChordQuality::Triad, 0, {}, chord);
+            for (int v = 0; v < 3; ++v)
+                triads[(size_t) d][(size_t) v] = chord.notes[(size_t) v] % 12;
+        }
+
+        minStepCost = std::numeric_limits<float>::max();
+        for (int from = 0; from <= 7; ++from)
+        {
+            for (int to = 1; to <= 7; ++to)
+            {
+                voiceLeading[(size_t) from][(size_t) to] = from == 0 ? 0.0f
+                    : voiceLeadingPerSemitone * (float) minimalMotion(triads[(size_t) from], triads[(size_t) to]);
+                minStepCost = juce::jmin(minStepCost, transitionCost[from][to] + voiceLeading[(size_t) from][(size_t) to]);
+            }
+        }
+    }
+
+    float SuggestionSearch::stepCost(int prev2, int prev1, int next) const
+    {
+        float cost = transitionCost[prev1][next] + voiceLeading[(size_t) prev1][(size_t) next];
+        if (prev2 != 0 && next == prev2 && next != prev1)
+            cost += pingPongPenalty;  // evita I-V-I-V...
+        return cost;
+    }
+
+    float SuggestionSearch::cadenceCost(int prev, int last)
+    {
+        if (last == 1) return (prev == 5 || prev == 7) ? 0.0f : 0.5f;  // auténtica / plagal u otras
+        if (last == 5) return 1.0f;                                   // semicadencia
+        if (last == 6 && prev == 5) return 1.5f;                      // rota
+        return 3.0f;
+    }
+
+    bool SuggestionSearch::search(Frame& f, int depth, float partial) const
+    {
+        ++nodesVisited;
+        if (f.shouldAbort && f.shouldAbort())
+            return false;
+
+        const int p2 = depth >= 2 ? f.path[(size_t) depth - 2] : (depth == 1 ? f.prev1 : f.prev2);
+        const int p1 = depth >= 1 ? f.path[(size_t) depth - 1] : f.prev1;
+
+        if (depth == f.length)
+        {
+            const float total = partial + cadenceCost(p2, p1);
+            if ((int) f.best.size() == maxResults && total >= f.best.back().cost)
+                return true;
+
+            Suggestion s;
+            s.degrees = f.path;
+            s.length = f.length;
+            s.cost = total;
+            auto pos = std::upper_bound(f.best.begin(), f.best.end(), total,
+                                        [](float c, const Suggestion& o) { return c < o.cost; });
+            f.best.insert(pos, s);
+            if ((int) f.best.size() > maxResults)
+                f.best.pop_back();
+            return true;
+        }
+
+        const float remainingBound = (float) (f.length - depth - 1) * minStepCost + minCadenceCost;
+        for (int next = 1; next <= 7; ++next)
+        {
+            const float cost = partial + stepCost(p2, p1, next);
+            // Poda: ni con el mejor caso posible en lo que queda se mejoraría el peor resultado guardado
+            if ((int) f.best.size() == maxResults && cost + remainingBound >= f.best.back().cost)
+                continue;
+
+            f.path[(size_t) depth] = next;
+            if (! search(f, depth + 1, cost))
+                return false;
+        }
+        return true;
+    }
+
+    bool SuggestionSearch::run(int prev2, int prev1, std::vector<Suggestion>& out, const std::function<bool()>& shouldAbort) const
+    {
+        nodesVisited = 0;
+        out.clear();
+
+        std::vector<Suggestion> candidates;
+        std::vector<Suggestion> best;
+        best.reserve(maxResults + 1);
+        for (int length = 1; length <= Suggestion::maxLength; ++length)
+        {
+            best.clear();
+            Frame f { length, juce::jlimit(0, 7, prev2), juce::jlimit(0, 7, prev1), {}, best, shouldAbort };
+            if (! search(f, 0, 0.0f))
+                return false;
+            for (auto s : best)
+            {
+                s.cost /= (float) length;
+                candidates.push_back(s);
+            }
+        }
+
+        // Primero la mejor continuación de cada longitud, luego el resto; todo por coste medio
+        std::stable_sort(candidates.begin(), candidates.end(),
+                         [](const Suggestion& a, const Suggestion& b) { return a.cost < b.cost; });
+        std::array<bool, Suggestion::maxLength + 1> lengthTaken {};
+        for (const auto& s : candidates)
+        {
+            if ((int) out.size() < maxResults && ! lengthTaken[(size_t) s.length])
+            {
+                lengthTaken[(size_t) s.length] = true;
+                out.push_back(s);
+            }
+        }
+        for (const auto& s : candidates)
+        {
+            if ((int) out.size() >= maxResults) break;
+            const bool already = std::any_of(out.begin(), out.end(), [&](const Suggestion& o)
+                                             { return o.length == s.length && o.degrees == s.degrees; });
+            if (! already)
+                out.push_back(s);
+        }
+        std::stable_sort(out.begin(), out.end(),
+                         [](const Suggestion& a, const Suggestion& b) { return a.cost < b.cost; });
+        return true;
+    }
+
+    //==============================================================================
+    SuggestionEngine::SuggestionEngine()
+        : juce::Thread("ChordCompanion suggestions")
+    {
+        startThread();
+    }
+
+    SuggestionEngine::~SuggestionEngine()
+    {
+        signalThreadShouldExit();
+        notify();
+        stopThread(2000);
+    }
+
+    void SuggestionEngine::request(const std::vector<int>& progression, ScaleType scale)
+    {
+        Context ctx;
+        const auto n = progression.size();
+        ctx.prev1 = n >= 1 ? progression[n - 1] : 0;
+        ctx.prev2 = n >= 2 ? progression[n - 2] : 0;
+        ctx.scale = (int) scale;
+
+        {
+            const juce::ScopedLock sl(lock);
+            if (hasPending && pending == ctx)
+                return;
+            pending = ctx;
+            hasPending = true;
+            ++generation;  // aborta la búsqueda en curso
+        }
+        notify();
+    }
+
+    std::vector<Suggestion> SuggestionEngine::getResults() const
+    {
+        const juce::ScopedLock sl(lock);
+        return results;
+    }
+
+    void SuggestionEngine::run()
+    {
+        std::vector<Suggestion> found;
+        while (! threadShouldExit())
+        {
+            Context ctx;
+            juce::uint32 gen = 0;
+            bool hasWork = false;
+            {
+                const juce::ScopedLock sl(lock);
+                if (hasPending)
+                {
+                    ctx = pending;
+                    gen = generation.load();
+                    hasPending = false;
+                    hasWork = true;
+                }
+            }
+
+            if (! hasWork)
+            {
+                wait(-1);
+                continue;
+            }
+
+            auto cached = resultCache.find(ctx);
+            if (cached != resultCache.end())
+            {
+                found = cached->second;
+            }
+            else
+            {
+                auto& search = searchCache[ctx.scale];
+                if (search == nullptr)
+                    search = std::make_unique<SuggestionSearch>((ScaleType) ctx.scale);
+
+                const std::function<bool()> shouldAbort = [this, gen] { return generation.load() != gen || threadShouldExit(); };
+                if (! search->run(ctx.prev2, ctx.prev1, found, shouldAbort))
+                    continue;  // hay una petición más reciente
+
+                resultCache.emplace(ctx, found);
+            }
+
+            {
+                const juce::ScopedLock sl(lock);
+                if (generation.load() != gen)
+                    continue;
+                results = found;
+            }
+            sendChangeMessage();
+        }
+    }
+}
@@ -0,0 +1,91 @@
+// SuggestionEngine.h
+// Sugerencias de continuación de la progresión: búsqueda con poda en un hilo de fondo
+
+#pragma once
+
+#include <juce_events/juce_events.h>
+#include <array>
+#include <functional>
+#include <map>
+#include "Parameters.h"
+#include "Theory.h"
+
+namespace cc
+{
+    struct Suggestion
+    {
+        static constexpr int maxLength = 4;
+
+        std::array<int, maxLength> degrees {};
+        int length = 0;
+        float cost = 0.0f;  // coste medio por acorde (menor = mejor)
+
+        std::vector<int> toVector() const { return { degrees.begin(), degrees.begin() + length }; }
+    };
+
+    // Búsqueda pura (sin hilos): enumera continuaciones de 1..4 grados y puntúa cadencia,
+    // conducción de voces y progresiones de práctica común. Ramificación y poda por longitud.
+    class SuggestionSearch
+    {
+    public:
+        static constexpr int maxResults = 4;
+
+        explicit SuggestionSearch(ScaleType scale);
+
+        // prev2/prev1: dos últimos grados de la progresión (0 = no hay). 'shouldAbort' se consulta
+        // en cada nodo; si devuelve true la búsqueda termina y devuelve false.
+        bool run(int prev2, int prev1, std::vector<Suggestion>& out, const std::function<bool()>& shouldAbort) const;
+
+        // Nodos visitados en la última búsqueda (diagnóstico de la poda)
+        int getNodesVisited() const { return nodesVisited; }
+
+    private:
+        struct Frame;
+
+        float stepCost(int prev2, int prev1, int next) const;
+        static float cadenceCost(int prev, int last);
+        bool search(Frame& f, int depth, float partial) const;
+
+        std::array<std::array<float, 8>, 8> voiceLeading {};  // [desde][hacia], grados 1..7 (0 = inicio)
+        float minStepCost = 0.0f;
+        mutable int nodesVisited = 0;
+    };
+
+    // Motor en hilo de fondo. request() solo toma el lock para copiar el contexto; una petición nueva
+    // aborta la búsqueda en curso. Los resultados se anuncian con sendChangeMessage (getResults()).
+    // La tonalidad no afecta al coste (todo es relativo a la escala), así que no forma parte del contexto.
+    class SuggestionEngine : public juce::ChangeBroadcaster,
+                             private juce::Thread
+    {
+    public:
+        SuggestionEngine();
+        ~SuggestionEngine() override;
+
+        void request(const std::vector<int>& progression, ScaleType scale);
+        std::vector<Suggestion> getResults() const;
+
+    private:
+        struct Context
+        {
+            int prev2 = 0, prev1 = 0, scale = 0;
+
+            auto tie() const { return std::tie(prev2, prev1, scale); }
+            bool operator<(const Context& o) const  { return tie() < o.tie(); }
+            bool operator==(const Context& o) const { return tie() == o.tie(); }
+        };
+
+        void run() override;
+
+        juce::CriticalSection lock;
+        Context pending;
+        bool hasPending = false;
+        std::atomic<juce::uint32> generation { 0 };
+        std::vector<Suggestion> results;
+
+        // Solo hilo de trabajo: resultados y tablas ya calculados (teclear reutiliza contextos previos)
+        std::map<Context, std::vector<Suggestion>> resultCache;
+        std::map<int, std::unique_ptr<SuggestionSearch>> searchCache;
+
+        JUCE_DECLARE_NON_COPYABLE(SuggestionEngine)
+    };
+}
@@ -6,83 +6,113 @@ namespace cc
 {
     std::vector<int> getScaleIntervals(ScaleType scale)
     {
+        const auto& table = getScaleIntervalTable(scale);
+        return { table.begin(), table.end() };
+    }
+
+    const std::array<int, 7>& getScaleIntervalTable(ScaleType scale)
+    {
+        static constexpr std::array<int, 7> major         { 0,2,4,5,7,9,11 };
+        static constexpr std::array<int, 7> naturalMinor  { 0,2,3,5,7,8,10 };
+        static constexpr std::array<int, 7> harmonicMinor { 0,2,3,5,7,8,11 };
+        static constexpr std::array<int, 7> dorian        { 0,2,3,5,7,9,10 };
+        static constexpr std::array<int, 7> mixolydian    { 0,2,4,5,7,9,10 };
+
         switch (scale)
         {
-            case ScaleType::Major:          return { 0,2,4,5,7,9,11 };
-            case ScaleType::NaturalMinor:   return { 0,2,3,5,7,8,10 };
-            case ScaleType::HarmonicMinor:  return { 0,2,3,5,7,8,11 };
-            case ScaleType::Dorian:         return { 0,2,3,5,7,9,10 };
-            case ScaleType::Mixolydian:     return { 0,2,4,5,7,9,10 };
-            default:                        return { 0,2,4,5,7,9,11 };
+            case ScaleType::Major:          return major;
+            case ScaleType::NaturalMinor:   return naturalMinor;
+            case ScaleType::HarmonicMinor:  return harmonicMinor;
+            case ScaleType::Dorian:         return dorian;
+            case ScaleType::Mixolydian:     return mixolydian;
+            default:                        return major;
         }
     }
 
     int degreeToMidi(int degree, int keySemitone, ScaleType scale, int octaveBase)
     {
         jassert(degree >= 1 && degree <= 7);
-        const auto intervals = getScaleIntervals(scale);
+        const auto& intervals = getScaleIntervalTable(scale);
         const int base = (octaveBase * 12) + keySemitone;
-        const int offset = intervals[juce::jlimit(1, 7, degree) - 1];
+        const int offset = intervals[(size_t) juce::jlimit(1, 7, degree) - 1];
         return base + offset;
     }
 
-    static int diatonicDegreeToSemitone(const std::vector<int>& intervals, int degree)
+    static int diatonicDegreeToSemitone(const std::array<int, 7>& intervals, int degree)
     {
         // degree puede ser >7 (para 9, 11, 13). Cada vuelta suma 12.
         const int wraps = (degree - 1) / 7;
         const int idx = (degree - 1) % 7;
-        return intervals[idx] + wraps * 12;
+        return intervals[(size_t) idx] + wraps * 12;
     }
 
-    std::vector<int> makeChordNotes(int rootMidi,
-                                    ScaleType scale,
-                                    ChordQuality quality,
-                                    int inversion,
-                                    const ExtensionToggles& toggles)
+    // Ordenación por inserción: como máximo 7 notas, sin asignaciones
+    static void sortNotes(ChordNotes& c)
+    {
+        for (int i = 1; i < c.size; ++i)
+        {
+            const int v = c.notes[(size_t) i];
+            int j = i - 1;
+            while (j >= 0 && c.notes[(size_t) j] > v)
+            {
+                c.notes[(size_t) j + 1] = c.notes[(size_t) j];
+                --j;
+            }
+            c.notes[(size_t) j + 1] = v;
+        }
+    }
+
+    void makeChordNotes(int rootMidi,
+                        ScaleType scale,
+                        ChordQuality quality,
+                        int inversion,
+                        const ExtensionToggles& toggles,
+                        ChordNotes& out)
     {
         // Construcción por terceras diatónicas: 1,3,5,7,9,11,13
-        const auto intervals = getScaleIntervals(scale);
+        const auto& intervals = getScaleIntervalTable(scale);
 
-        std::vector<int> degrees = { 1, 3, 5 };
-        if (quality >= ChordQuality::Seventh || toggles.add7)    degrees.push_back(7);
-        if (quality >= ChordQuality::Ninth   || toggles.add9)    degrees.push_back(9);
-        if (quality >= ChordQuality::Eleventh|| toggles.add11)   degrees.push_back(11);
-        if (quality >= ChordQuality::Thirteenth || toggles.add13) degrees.push_back(13);
+        std::array<int, ChordNotes::maxNotes> degrees { 1, 3, 5 };
+        int numDegrees = 3;
+        if (quality >= ChordQuality::Seventh || toggles.add7)    degrees[(size_t) numDegrees++] = 7;
+        if (quality >= ChordQuality::Ninth   || toggles.add9)    degrees[(size_t) numDegrees++] = 9;
+        if (quality >= ChordQuality::Eleventh|| toggles.add11)   degrees[(size_t) numDegrees++] = 11;
+        if (quality >= ChordQuality::Thirteenth || toggles.add13) degrees[(size_t) numDegrees++] = 13;
 
-        std::vector<int> notes;
-        notes.reserve(degrees.size());
-        for (int d : degrees)
-        {
-            const int semi = diatonicDegreeToSemitone(intervals, d);
-            notes.push_back(rootMidi + semi);
-        }
+        out.size = numDegrees;
+        for (int i = 0; i < numDegrees; ++i)
+            out.notes[(size_t) i] = rootMidi + diatonicDegreeToSemitone(intervals, degrees[(size_t) i]);
 
         // Aplicar inversión: mueve la nota más baja 12 semitonos arriba por cada inversión
-        const int maxInv = (int) juce::jmin((int) degrees.size() - 1, inversion);
+        const int maxInv = juce::jmin(numDegrees - 1, inversion);
         for (int i = 0; i < maxInv; ++i)
         {
-            // mover la más baja al final +12
-            std::sort(notes.begin(), notes.end());
-            notes.front() += 12;
+            sortNotes(out);
+            out.notes[0] += 12;
         }
 
         // Ajuste de rango agradable (48–84)
-        auto clampIntoRange = [](std::vector<int>& ns)
+        for (int iter = 0; iter < 8; ++iter)
         {
-            if (ns.empty()) return;
-            for (int iter = 0; iter < 8; ++iter)
-            {
-                int mn = *std::min_element(ns.begin(), ns.end());
-                int mx = *std::max_element(ns.begin(), ns.end());
-                if (mn < 48) { for (auto& n : ns) n += 12; continue; }
-                if (mx > 84) { for (auto& n : ns) n -= 12; continue; }
-                break; // dentro de rango
-            }
-        };
-        clampIntoRange(notes);
+            const int mn = *std::min_element(out.begin(), out.end());
+            const int mx = *std::max_element(out.begin(), out.end());
+            if (mn < 48) { for (int i = 0; i < out.size; ++i) out.notes[(size_t) i] += 12; continue; }
+            if (mx > 84) { for (int i = 0; i < out.size; ++i) out.notes[(size_t) i] -= 12; continue; }
+            break; // dentro de rango
+        }
 
         // Ordenar ascendente por estética
-        std::sort(notes.begin(), notes.end());
-        return notes;
+        sortNotes(out);
+    }
+
+    std::vector<int> makeChordNotes(int rootMidi,
+                                    ScaleType scale,
+                                    ChordQuality quality,
+                                    int inversion,
+                                    const ExtensionToggles& toggles)
+    {
+        ChordNotes chord;
+        makeChordNotes(rootMidi, scale, quality, inversion, toggles, chord);
+        return { chord.begin(), chord.end() };
     }
 }
\ No newline at end of file
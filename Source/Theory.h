@@ -4,6 +4,7 @@
 #pragma once
 
 #include <juce_core/juce_core.h>
+#include <array>
 #include "Parameters.h"
 
 namespace cc
@@ -11,6 +12,9 @@ namespace cc
     // Devuelve los offsets en semitonos desde la tónica para grados 1..7
     std::vector<int> getScaleIntervals(ScaleType scale);
 
+    // Igual que getScaleIntervals pero sin asignaciones (tabla estática), apto para el hilo de audio
+    const std::array<int, 7>& getScaleIntervalTable(ScaleType scale);
+
     // Grado (1..7) a nota MIDI raíz basándose en keySemitone y octaveBase
     int degreeToMidi(int degree, int keySemitone, ScaleType scale, int octaveBase);
 
@@ -22,6 +26,27 @@ namespace cc
         bool add13 = false;
     };
 
+    // Acorde de tamaño fijo (1-3-5-7-9-11-13 como máximo): no asigna memoria
+    struct ChordNotes
+    {
+        static constexpr int maxNotes = 7;
+
+        std::array<int, maxNotes> notes {};
+        int size = 0;
+
+        const int* begin() const { return notes.data(); }
+        const int* end() const   { return notes.data() + size; }
+        bool isEmpty() const     { return size == 0; }
+    };
+
+    // Versión sin asignaciones de makeChordNotes (mismo resultado, ordenado ascendente)
+    void makeChordNotes(int rootMidi,
+                        ScaleType scale,
+                        ChordQuality quality,
+                        int inversion,
+                        const ExtensionToggles& toggles,
+                        ChordNotes& out);
+
     // Construye notas del acorde por terceras diatónicas hasta quality, aplicando inversiones.
     // Ajusta las notas a un rango agradable (48–84 aprox.)
     std::vector<int> makeChordNotes(int rootMidi,
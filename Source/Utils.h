@@ -13,22 +13,6 @@ namespace cc
         return static_cast<int>(std::round(sampleRate * static_cast<double>(ms) / 1000.0));
     }
 
-    // Devuelve un delta aleatorio en samples dentro de ±maxMs
-    inline int humanizeMsToSamples(double sampleRate, int maxMs, juce::Random& rng)
-    {
-        if (maxMs <= 0) return 0;
-        const int range = msToSamples(sampleRate, maxMs);
-        return rng.nextInt(juce::Range<int>(-range, range + 1));
-    }
-
-    // Humaniza la velocidad con clamp 1–127
-    inline int humanizeVelocity(int base, int maxDelta, juce::Random& rng)
-    {
-        if (maxDelta <= 0) return juce::jlimit(1, 127, base);
-        const int delta = rng.nextInt(juce::Range<int>(-maxDelta, maxDelta + 1));
-        return juce::jlimit(1, 127, base + delta);
-    }
-
     // Parser de progresión: "1-5-6-4" -> {1,5,6,4}
     inline std::vector<int> parseProgressionString(const juce::String& s)
     {
@@ -72,8 +56,9 @@ namespace cc
         return juce::MidiMessage::getMidiNoteName(midiNote, true /*useSharps*/, true /*includeOctave*/, 4 /*middleC*/);
     }
 
-    // Convierte vector de notas a string legible "C4 E4 G4"
-    inline juce::String notesToString(const std::vector<int>& notes)
+    // Convierte notas (std::vector<int>, ChordNotes...) a string legible "C4 E4 G4"
+    template <typename NoteRange>
+    inline juce::String notesToString(const NoteRange& notes)
     {
         juce::StringArray arr;
         for (int n : notes) arr.add(midiNoteToName(n));
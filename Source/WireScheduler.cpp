@@ -0,0 +1,183 @@
+// WireScheduler.cpp
+
+#include "WireScheduler.h"
+#include "BlockEventList.h"
+#include <algorithm>
+#include <limits>
+
+namespace cc
+{
+    namespace
+    {
+        bool isWireChannelMessage(const juce::MidiMessageMetadata& meta) noexcept
+        {
+            return meta.numBytes >= 1 && meta.numBytes <= 3 && meta.data[0] >= 0x80 && meta.data[0] < 0xf0;
+        }
+    }
+
+    void WireScheduler::prepare(double newSampleRate)
+    {
+        sampleRate = newSampleRate;
+        samplesPerByte = newSampleRate * bitsPerByte / baudRate;
+        reset();
+    }
+
+    void WireScheduler::reset()
+    {
+        wireFreeAt = 0.0;
+        runningStatus = 0;
+        numIncoming = 0;
+        pendingHead = numPending = 0;
+        chordTime = -1;
+        lastSkewMs = 0.0f;
+        maxSkewMs = 0.0f;
+    }
+
+    void WireScheduler::process(juce::MidiBuffer& midi, juce::MidiBuffer& scratch, juce::int64 blockStart, int numSamples)
+    {
+        if (midi.isEmpty() && numPending == 0)
+            return;
+
+        const juce::int64 blockEnd = blockStart + numSamples;
+
+        scratch.clear();
+        scratch.data.addArray(midi.data.begin(), midi.data.size());
+        midi.clear();
+
+        // Mensajes de canal al modelo (hasta maxEvents); el resto conserva su posición
+        numIncoming = 0;
+        for (const auto meta : scratch)
+        {
+            if (! isWireChannelMessage(meta) || numIncoming >= maxEvents)
+                continue;
+
+            auto& e = incoming[(size_t) numIncoming];
+            e.time = blockStart + meta.samplePosition;
+            e.size = meta.numBytes;
+            std::copy(meta.data, meta.data + meta.numBytes, e.data);
+
+            const int type = meta.data[0] & 0xf0;
+            const bool noteOff = type == 0x80 || (type == 0x90 && meta.numBytes >= 3 && meta.data[2] == 0);
+            const juce::uint32 rank = noteOff ? 0 : type == 0x90 ? 2 : 1;
+            e.order = (rank << 16) | ((juce::uint32) meta.data[0] << 8) | (meta.numBytes >= 2 ? meta.data[1] : 0);
+            e.sequence = numIncoming++;
+        }
+
+        std::sort(incoming.begin(), incoming.begin() + numIncoming, [](const Event& a, const Event& b)
+        {
+            if (a.time != b.time)   return a.time < b.time;
+            if (a.order != b.order) return a.order < b.order;
+            return a.sequence < b.sequence;
+        });
+
+        // Salida: eventos de canal en orden de envío, intercalados con los de sistema en su posición
+        auto passthrough = scratch.begin();
+        const auto passthroughEnd = scratch.end();
+        int modelledSkipped = 0;
+        auto emitPassthroughUpTo = [&](int pos)
+        {
+            for (; passthrough != passthroughEnd; ++passthrough)
+            {
+                const auto meta = *passthrough;
+                if (isWireChannelMessage(meta) && modelledSkipped < numIncoming)
+                {
+                    ++modelledSkipped;
+                    continue;
+                }
+                if (meta.samplePosition > pos)
+                    break;
+                if (meta.numBytes > 0 && meta.data[0] >= 0xf0 && meta.data[0] < 0xf8)
+                    runningStatus = 0;  // SysEx y mensajes comunes cancelan el running status
+                appendInOrder(midi, meta.samplePosition, meta.data, meta.numBytes);
+            }
+        };
+        auto emit = [&](juce::int64 time, const Event& e)
+        {
+            const int pos = (int) juce::jlimit((juce::int64) 0, (juce::int64) numSamples - 1, time - blockStart);
+            emitPassthroughUpTo(pos);
+            appendInOrder(midi, pos, e.data, e.size);
+        };
+
+        // Lo programado en bloques anteriores que ya toca enviar
+        while (numPending > 0 && pending[(size_t) pendingHead].time < blockEnd)
+        {
+            const auto& e = pending[(size_t) pendingHead];
+            emit(e.time, e);
+            pendingHead = (pendingHead + 1) % maxEvents;
+            --numPending;
+        }
+
+        for (int i = 0; i < numIncoming; ++i)
+        {
+            const auto& e = incoming[(size_t) i];
+            const int bytes = e.size - (e.data[0] == runningStatus ? 1 : 0);
+            runningStatus = e.data[0];
+
+            const double start = juce::jmax((double) e.time, wireFreeAt);
+            wireFreeAt = start + bytes * samplesPerByte;
+
+            if ((e.order >> 16) == 2)
+            {
+                if (e.time != chordTime)
+                {
+                    closeChord();
+                    chordTime = e.time;
+                    firstArrival = wireFreeAt;
+                }
+                lastArrival = wireFreeAt;
+            }
+
+            const auto sendTime = (juce::int64) start;
+            if (sendTime < blockEnd)
+            {
+                emit(sendTime, e);
+            }
+            else if (numPending < maxEvents)
+            {
+                auto& p = pending[(size_t) ((pendingHead + numPending++) % maxEvents)];
+                p = e;
+                p.time = sendTime;
+            }
+            else
+            {
+                emit(blockEnd - 1, e);  // espera llena: mejor tarde en este bloque que perderlo
+            }
+        }
+        closeChord();
+
+        emitPassthroughUpTo(std::numeric_limits<int>::max());
+    }
+
+    void WireScheduler::flush(juce::MidiBuffer& midi, juce::MidiBuffer& scratch)
+    {
+        if (numPending > 0)
+        {
+            scratch.clear();
+            scratch.data.addArray(midi.data.begin(), midi.data.size());
+            midi.clear();
+
+            // Lo que esperaba ya debía haber salido: va delante de todo lo del bloque
+            for (; numPending > 0; --numPending)
+            {
+                const auto& e = pending[(size_t) pendingHead];
+                appendInOrder(midi, 0, e.data, e.size);
+                pendingHead = (pendingHead + 1) % maxEvents;
+            }
+            for (const auto meta : scratch)
+                appendInOrder(midi, meta.samplePosition, meta.data, meta.numBytes);
+        }
+        reset();
+    }
+
+    void WireScheduler::closeChord()
+    {
+        if (chordTime < 0)
+            return;
+
+        const auto skew = (float) ((lastArrival - firstArrival) * 1000.0 / sampleRate);
+        lastSkewMs.store(skew, std::memory_order_relaxed);
+        if (skew > maxSkewMs.load(std::memory_order_relaxed))
+            maxSkewMs.store(skew, std::memory_order_relaxed);
+        chordTime = -1;
+    }
+}
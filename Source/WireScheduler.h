@@ -0,0 +1,71 @@
+// WireScheduler.h
+// Modelo del cable MIDI DIN en la salida: un acorde sale como ráfaga en el mismo sample, pero un puerto
+// a 31,25 kbaud entrega un byte cada 320 us. Se ordenan los eventos simultáneos y se reparten al ritmo
+// del cable, de modo que el orden de llegada lo decide el plugin y no el driver.
+
+#pragma once
+
+#include <juce_audio_basics/juce_audio_basics.h>
+#include <array>
+#include <atomic>
+
+namespace cc
+{
+    // Por cada grupo de eventos con el mismo sample:
+    //  - note-offs primero, luego el resto de mensajes de canal (CC, bend...) y por último los note-ons;
+    //    dentro de cada clase, agrupados por status (running status) y los note-ons de grave a agudo
+    //  - cada evento empieza cuando el cable queda libre; lo que no cabe en el bloque pasa a los siguientes
+    // Los mensajes de sistema (reloj, SysEx) pasan sin tocar y no ocupan el cable del modelo.
+    class WireScheduler
+    {
+    public:
+        static constexpr int baudRate = 31250;
+        static constexpr int bitsPerByte = 10;   // start + 8 datos + stop
+        static constexpr int maxEvents = 1024;   // mensajes de canal por bloque y en espera
+
+        void prepare(double sampleRate);
+        void reset();
+
+        // Hilo de audio. Reescribe 'midi' (ordenado) con los instantes de envío; 'scratch' preasignado
+        // para la entrada del bloque (BlockEventList::maxEvents) más maxEvents en espera.
+        void process(juce::MidiBuffer& midi, juce::MidiBuffer& scratch, juce::int64 blockStart, int numSamples);
+
+        // Al desactivar el modelo: lo que quedaba en espera sale al principio del bloque (misma mezcla por 'scratch')
+        void flush(juce::MidiBuffer& midi, juce::MidiBuffer& scratch);
+
+        // Desfase estimado entre el primer y el último note-on de un acorde al llegar al sintetizador
+        float getLastChordSkewMs() const noexcept { return lastSkewMs.load(std::memory_order_relaxed); }
+        float getMaxChordSkewMs() const noexcept  { return maxSkewMs.load(std::memory_order_relaxed); }
+
+    private:
+        struct Event
+        {
+            juce::int64 time = 0;   // entrada: sample nominal; en espera: instante de envío ya calculado
+            juce::uint32 order = 0; // clase, status y nota: orden dentro del mismo sample
+            int sequence = 0;       // desempate: orden de llegada
+            juce::uint8 data[3] {};
+            int size = 0;
+        };
+
+        void closeChord();
+
+        double samplesPerByte = 0.0;
+        double sampleRate = 44100.0;
+        double wireFreeAt = 0.0;        // sample absoluto en que termina el último byte enviado
+        juce::uint8 runningStatus = 0;
+
+        std::array<Event, maxEvents> incoming {};
+        int numIncoming = 0;
+
+        // FIFO de eventos ya programados que caen en bloques posteriores
+        std::array<Event, maxEvents> pending {};
+        int pendingHead = 0, numPending = 0;
+
+        // Acorde en curso: note-ons con el mismo sample nominal
+        juce::int64 chordTime = -1;
+        double firstArrival = 0.0, lastArrival = 0.0;
+
+        std::atomic<float> lastSkewMs { 0.0f };
+        std::atomic<float> maxSkewMs { 0.0f };
+    };
+}
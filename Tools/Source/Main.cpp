@@ -0,0 +1,350 @@
+// Main.cpp
+// Herramientas de consola de ChordCompanion: compilan las mismas fuentes que el plugin (build unity)
+// y las ejercitan sin host ni editor.
+
+#include <JuceHeader.h>
+#include <algorithm>
+#include <array>
+#include <functional>
+#include <iostream>
+#include <limits>
+#include <vector>
+
+#include "../../Source/PluginProcessor.cpp"
+#include "../../Source/PluginEditor.cpp"
+
+namespace
+{
+    // --replay: reproduce una sesión grabada desde el editor (.ccsession) e imprime sus estadísticas
+    void runReplay(const juce::ArgumentList& args)
+    {
+        args.checkMinNumArguments(2);
+        const auto source = args[1].resolveAsExistingFile();
+
+        ChordCompanionAudioProcessor::ReplayStats stats;
+        if (! ChordCompanionAudioProcessor::replaySession(source, stats))
+            juce::ConsoleApplication::fail("Could not replay " + source.getFullPathName());
+
+        const double averageMicros = stats.blocks > 0 ? stats.totalMicros / stats.blocks : 0.0;
+        std::cout << "Session:        " << source.getFullPathName() << "\n"
+                  << "Blocks:         " << stats.blocks << " (" << stats.droppedBlocks << " lost while recording)\n"
+                  << "Output events:  " << stats.outputEvents << "\n"
+                  << "processBlock:   avg " << juce::String(averageMicros, 2) << " us, max "
+                                            << juce::String(stats.maxMicros, 2) << " us, total "
+                                            << juce::String(stats.totalMicros / 1000.0, 2) << " ms\n"
+                  << "Output hash:    " << juce::String::toHexString((juce::int64) stats.outputHash).paddedLeft('0', 16) << std::endl;
+    }
+
+    //==============================================================================
+    // --bench-emit: camino de emisión anterior a los núcleos especializados frente al que elige
+    // selectChordEmitter, sobre los mismos acordes y parámetros
+    struct BenchSink
+    {
+        juce::uint64 hash = 14695981039346656037ull;
+        int notes = 0;
+
+        bool reserve(int) { return true; }
+        void note(juce::int64 on, juce::int64 off, int note, int velocity)
+        {
+            for (const auto value : { (juce::uint64) on, (juce::uint64) off, (juce::uint64) note, (juce::uint64) velocity })
+                hash = (hash ^ value) * 1099511628211ull;
+            ++notes;
+        }
+    };
+
+    struct BenchCase
+    {
+        const char* name;
+        cc::ChordQuality quality;
+        cc::PatternMode pattern;
+        int humanizeSamples;
+        int humanizeVel;
+        bool hostSync;
+    };
+
+    struct BenchResult
+    {
+        double nanosPerChord = 0.0;
+        juce::uint64 hash = 0;
+        int notes = 0;
+    };
+
+    // Copia de referencia del bucle de emisión en vivo previo a la especialización: expande siempre el
+    // patrón, humaniza siempre y decide la cuantización en tiempo de ejecución
+    int emitChordPreSpecialisation(const cc::ChordEmitParams& p, bool quantize, const cc::ChordNotes& chord,
+                                   cc::ChordEmitScratch& s, BenchSink& sink)
+    {
+        int quantizeShift = 0;
+        if (quantize)
+        {
+            const double target = std::round(p.ppq / p.gridQN) * p.gridQN;
+            quantizeShift = juce::jmax(-p.maxEarly, (int) std::llround((target - p.ppq) * p.samplesPerQN));
+        }
+
+        const juce::int64 chordStart = p.start + quantizeShift;
+        const cc::PatternTiming timing { chordStart, p.length, p.step, p.strum, p.ratchet };
+        const int numNotes = cc::expandPattern(p.pattern, chord, timing, s.pattern);
+        if (! sink.reserve(2 * numNotes))
+            return 0;
+
+        s.humanize.generate(s.rng, numNotes, p.humanizeSamples, p.velocity, p.humanizeVel);
+        for (int i = 0; i < numNotes; ++i)
+        {
+            const auto& pn = s.pattern[(size_t) i];
+            const int vel  = s.humanize.velocities[(size_t) i];
+            const int hOn  = s.humanize.onOffsets[(size_t) i];
+            const int hOff = s.humanize.offOffsets[(size_t) i];
+
+            const juce::int64 onTime  = juce::jmax(p.earliest, pn.on + hOn);
+            const juce::int64 offTime = juce::jmax(onTime + 1, pn.off + hOff);
+            sink.note(onTime, offTime, pn.note, vel);
+        }
+        return numNotes;
+    }
+
+    template <typename Emit>
+    BenchResult timeEmitter(Emit&& emit, const cc::ChordEmitParams& base,
+                            const std::vector<cc::ChordNotes>& chords, int numChords)
+    {
+        cc::PatternNotes pattern;
+        cc::HumanizeBatch humanize;
+        BenchResult best;
+        best.nanosPerChord = std::numeric_limits<double>::max();
+
+        // La mejor de varias pasadas: descarta interrupciones del sistema
+        for (int pass = 0; pass < 5; ++pass)
+        {
+            cc::FastRandom rng(1234);
+            cc::ChordEmitScratch scratch { pattern, humanize, rng };
+            BenchSink sink;
+            auto params = base;
+
+            const auto start = juce::Time::getHighResolutionTicks();
+            for (int i = 0; i < numChords; ++i)
+            {
+                params.start = params.earliest = (juce::int64) i * 24000;
+                params.ppq = i * 0.37;
+                emit(params, chords[(size_t) i % chords.size()], scratch, sink);
+            }
+            const double seconds = juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - start);
+
+            best.nanosPerChord = juce::jmin(best.nanosPerChord, seconds * 1.0e9 / numChords);
+            best.hash = sink.hash;
+            best.notes = sink.notes;
+        }
+        return best;
+    }
+
+    void runEmitBench(const juce::ArgumentList& args)
+    {
+        const int numChords = args.containsOption("--chords") ? juce::jmax(1, args.getValueForOption("--chords").getIntValue()) : 200000;
+
+        const BenchCase cases[] = {
+            { "triad, block",              cc::ChordQuality::Triad,      cc::PatternMode::Block,   0,   0,  false },
+            { "seventh, block",            cc::ChordQuality::Seventh,    cc::PatternMode::Block,   0,   0,  false },
+            { "triad, block, humanized",   cc::ChordQuality::Triad,      cc::PatternMode::Block,   240, 10, false },
+            { "triad, block, quantized",   cc::ChordQuality::Triad,      cc::PatternMode::Block,   0,   0,  true },
+            { "ninth, arp up",             cc::ChordQuality::Ninth,      cc::PatternMode::ArpUp,   0,   0,  false },
+            { "thirteenth, strum, all",    cc::ChordQuality::Thirteenth, cc::PatternMode::StrumUp, 240, 10, true },
+        };
+
+        std::cout << numChords << " chords per pass, best of 5\n\n"
+                  << juce::String("case").paddedRight(' ', 28) << juce::String("pre-specialisation").paddedLeft(' ', 20)
+                  << juce::String("specialised").paddedLeft(' ', 14) << juce::String("speed-up").paddedLeft(' ', 10) << "  output\n";
+
+        bool allMatch = true;
+        for (const auto& c : cases)
+        {
+            // Los siete grados de Do mayor, como los resuelve el plan
+            std::vector<cc::ChordNotes> chords(7);
+            for (int degree = 1; degree <= 7; ++degree)
+                cc::makeChordNotes(cc::degreeToMidi(degree, 0, cc::ScaleType::Major, 4), cc::ScaleType::Major,
+                                   c.quality, 0, {}, chords[(size_t) degree - 1]);
+
+            cc::ChordEmitParams params;
+            params.length          = 24000;
+            params.step            = 6000;
+            params.strum           = 480;
+            params.pattern         = c.pattern;
+            params.humanizeSamples = c.humanizeSamples;
+            params.humanizeVel     = c.humanizeVel;
+            params.gridQN          = c.hostSync ? 0.25 : 1.0;
+            params.samplesPerQN    = c.hostSync ? 24000.0 : 1.0;
+            params.maxEarly        = c.hostSync ? 2400 : 0;
+
+            cc::ChordEmitFlags flags;
+            flags.humanize   = c.humanizeSamples > 0 || c.humanizeVel > 0;
+            flags.extensions = c.quality != cc::ChordQuality::Triad;
+            flags.patterned  = c.pattern != cc::PatternMode::Block;
+            flags.hostSync   = c.hostSync;
+
+            const auto reference = [quantize = c.hostSync] (const cc::ChordEmitParams& p, const cc::ChordNotes& chord,
+                                                            cc::ChordEmitScratch& s, BenchSink& sink)
+            {
+                return emitChordPreSpecialisation(p, quantize, chord, s, sink);
+            };
+            const auto a = timeEmitter(reference, params, chords, numChords);
+            const auto b = timeEmitter(cc::selectChordEmitter<BenchSink>(flags), params, chords, numChords);
+
+            // Sin humanizar la referencia consume igualmente el generador, pero los desvíos son 0: salida idéntica
+            const bool match = a.hash == b.hash && a.notes == b.notes;
+            allMatch = allMatch && match;
+
+            std::cout << juce::String(c.name).paddedRight(' ', 28)
+                      << (juce::String(a.nanosPerChord, 1) + " ns").paddedLeft(' ', 20)
+                      << (juce::String(b.nanosPerChord, 1) + " ns").paddedLeft(' ', 14)
+                      << (juce::String(a.nanosPerChord / juce::jmax(1.0e-9, b.nanosPerChord), 2) + "x").paddedLeft(' ', 10)
+                      << "  " << (match ? "identical" : "DIFFERENT") << "\n";
+        }
+
+        std::cout << std::flush;
+        if (! allMatch)
+            juce::ConsoleApplication::fail("Specialised kernels do not match the pre-specialisation path", 2);
+    }
+
+    //==============================================================================
+    // --check: invariantes que no necesitan host
+    using Expect = std::function<void(bool ok, const juce::String& what)>;
+
+    // Modo teclado: la octava de la tecla fija el registro. C2 (36) y C4 (60) deben dar el mismo
+    // acorde a dos octavas de distancia, tanto el memoizado en el plan como el calculado en vivo.
+    void checkKeyChordRegisters(const Expect& expect)
+    {
+        for (int key = 0; key < 12; ++key)
+            for (int scale = 0; scale < 2; ++scale)
+                for (int quality = 0; quality <= (int) cc::ChordQuality::Thirteenth; ++quality)
+                {
+                    cc::PlanInputs in;
+                    in.key = key;
+                    in.scale = scale;
+                    in.quality = quality;
+                    const auto plan = cc::ProgressionPlan::build(in, "1-5-6-4", 1);
+
+                    cc::ChordNotes low, high;
+                    cc::ProgressionPlan::makeKeyChord(in, 36, low);
+                    cc::ProgressionPlan::makeKeyChord(in, 60, high);
+
+                    const auto name = "key " + juce::String(key) + ", scale " + juce::String(scale) + ", quality " + juce::String(quality);
+                    bool twoOctaves = low.size > 0 && low.size == high.size;
+                    for (int i = 0; twoOctaves && i < low.size; ++i)
+                        twoOctaves = high.notes[(size_t) i] - low.notes[(size_t) i] == 24;
+                    expect(twoOctaves, name + ": C2 " + cc::notesToString(low) + " vs C4 " + cc::notesToString(high));
+
+                    for (const int note : { 36, 60 })
+                    {
+                        const auto& cached = plan.keyChords[(size_t) note];
+                        const auto& live = note == 36 ? low : high;
+                        expect(std::equal(cached.begin(), cached.end(), live.begin(), live.end()),
+                               name + ": plan and live key chords differ at note " + juce::String(note));
+                    }
+                }
+    }
+
+    // Reloj MIDI: con la cola anclada al reloj, un stop (0xFC) la pausa y suelta sus notas; después no
+    // sale nada de ella, ni mientras siguen llegando pulsos ni cuando dejan de llegar (enganche perdido)
+    void checkClockStopPausesQueue(const Expect& expect)
+    {
+        constexpr double sampleRate = 48000.0;
+        constexpr int blockSize = 512;
+        constexpr int samplesPerTick = 1000;   // 120 bpm
+        constexpr int generateBlock = 60, stopBlock = 150, ticksEndBlock = 300, lastBlock = 500;
+
+        ChordCompanionAudioProcessor p;
+        p.apvts.getParameter(cc::ParamID::clockSync)->setValueNotifyingHost(1.0f);
+        p.setRateAndBufferSizeDetails(sampleRate, blockSize);
+        p.prepareToPlay(sampleRate, blockSize);
+
+        juce::AudioBuffer<float> buffer(2, blockSize);
+        std::array<int, 128> sounding {};
+        int onsBeforeStop = 0, onsAfterStop = 0;
+        juce::int64 nextTick = 0;
+
+        for (int block = 0; block < lastBlock; ++block)
+        {
+            const juce::int64 blockStart = (juce::int64) block * blockSize;
+            juce::MidiBuffer midi;
+            if (block == 0)
+                midi.addEvent(juce::MidiMessage(0xfa), 0);
+            if (block == stopBlock)
+                midi.addEvent(juce::MidiMessage(0xfc), 0);
+            for (; nextTick < blockStart + blockSize; nextTick += samplesPerTick)
+                if (block < ticksEndBlock)
+                    midi.addEvent(juce::MidiMessage(0xf8), (int) (nextTick - blockStart));
+
+            if (block == generateBlock)
+                p.postCommand({ cc::Command::Type::Generate });
+
+            p.processBlock(buffer, midi);
+
+            // La cola toca en el canal 2
+            for (const auto meta : midi)
+            {
+                const auto m = meta.getMessage();
+                if (m.getChannel() != 2)
+                    continue;
+                if (m.isNoteOn())
+                {
+                    ++sounding[(size_t) m.getNoteNumber()];
+                    ++(block < stopBlock ? onsBeforeStop : onsAfterStop);
+                }
+                else if (m.isNoteOff() && sounding[(size_t) m.getNoteNumber()] > 0)
+                {
+                    --sounding[(size_t) m.getNoteNumber()];
+                }
+            }
+
+            if (block == stopBlock)
+                expect(std::all_of(sounding.begin(), sounding.end(), [](int n) { return n == 0; }),
+                       "clock stop: queue notes still sounding after 0xFC");
+        }
+
+        expect(onsBeforeStop > 0, "clock stop: the queue never played while the clock was running");
+        expect(onsAfterStop == 0, "clock stop: " + juce::String(onsAfterStop) + " queue note-ons after 0xFC");
+    }
+
+    void runChecks(const juce::ArgumentList&)
+    {
+        int failures = 0;
+        const Expect expect = [&failures](bool ok, const juce::String& what)
+        {
+            if (! ok)
+            {
+                std::cout << "FAIL: " << what << "\n";
+                ++failures;
+            }
+        };
+
+        checkKeyChordRegisters(expect);
+        checkClockStopPausesQueue(expect);
+
+        if (failures > 0)
+            juce::ConsoleApplication::fail(juce::String(failures) + " check(s) failed", 2);
+        std::cout << "All checks passed" << std::endl;
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    // El procesador usa AsyncUpdater y ChangeBroadcaster: necesitan un MessageManager
+    juce::ScopedJuceInitialiser_GUI juceInitialiser;
+
+    juce::ConsoleApplication app;
+    app.addHelpCommand("--help|-h", "ChordCompanion tools", true);
+    app.addCommand({ "--replay",
+                     "--replay <session.ccsession>",
+                     "Replays a recorded session at full speed and prints block timing and the output hash.",
+                     "Sessions with a fixed seed produce the same hash on every run; compare it across builds.",
+                     runReplay });
+    app.addCommand({ "--bench-emit",
+                     "--bench-emit [--chords=<n>]",
+                     "Times the generic chord emission path against the specialised kernels and prints the speed-up.",
+                     "Both paths emit the same chords with the same parameters; their outputs are hashed and must match.",
+                     runEmitBench });
+    app.addCommand({ "--check",
+                     "--check",
+                     "Runs the self-checks (key chord registers, MIDI clock stop) and fails if any of them is broken.",
+                     "",
+                     runChecks });
+
+    return app.findAndRunCommand(argc, argv);
+}